@@ -0,0 +1,461 @@
+#include <cxxopts.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+#include "FilesManager/FilesManager.hpp"
+#include "ObjectsManager/ObjectsManager.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Toxiconfig.h"
+
+namespace fs = std::filesystem;
+namespace json = nlohmann;
+
+// left in the corpus directory, only a directory holding it is ever emptied
+constexpr std::string_view CorpusMarker = ".toxidoc_bench";
+
+/**
+ * @brief Shape of the synthetic header tree
+ *
+ * @struct CorpusShape
+ */
+struct CorpusShape {
+  size_t files;
+  size_t classes;
+  size_t functions;
+  size_t overloads;
+  size_t depth;
+  size_t qtPercent;
+};
+
+/**
+ * @brief Wall time and resident memory of a measured call
+ *
+ * @struct Measurement
+ */
+struct Measurement {
+  double seconds = 0;
+  // memory kept by the call, negative when it released more than it took
+  int64_t rssGrowthBytes = 0;
+  // highest resident memory reached during the call, above the one it started from
+  size_t peakRssGrowthBytes = 0;
+};
+
+/**
+ * @brief Measures the wall time and the resident memory growth of a call
+ *
+ * @arg call
+ *
+ * @return Measurement
+ */
+template <typename F>
+static auto measure(F &&call) -> Measurement {
+  Profiler::resetPeakMemory();
+  MemoryUsage before = Profiler::readMemoryUsage();
+  auto start = std::chrono::steady_clock::now();
+  call();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  MemoryUsage after = Profiler::readMemoryUsage();
+  return {seconds, static_cast<int64_t>(after.rssBytes) - static_cast<int64_t>(before.rssBytes),
+          after.peakRssBytes > before.rssBytes ? after.peakRssBytes - before.rssBytes : 0};
+}
+
+/**
+ * @brief Writes one JSON line for a phase, every count gets its rate per second next to it, the memory growth of
+ * the phase is written in bytes
+ *
+ * @arg out
+ * @arg context settings shared by every record of the run
+ * @arg phase
+ * @arg measurement
+ * @arg counts
+ * @arg details values written as they are
+ *
+ * @return void
+ */
+static auto emitRecord(std::ostream &out, const json::json &context, const std::string &phase,
+                       const Measurement &measurement, const json::json &counts,
+                       const json::json &details = json::json::object()) -> void {
+  json::json record = context;
+  record.update(details);
+  record["phase"] = phase;
+  record["seconds"] = measurement.seconds;
+  record["rss_growth_bytes"] = measurement.rssGrowthBytes;
+  record["peak_rss_growth_bytes"] = measurement.peakRssGrowthBytes;
+  for (const auto &[key, value] : counts.items()) {
+    record[key] = value;
+    if (value.is_number() && measurement.seconds > 0)
+      record[key + "_per_s"] = value.get<double>() / measurement.seconds;
+  }
+  out << record.dump() << std::endl;
+}
+
+/**
+ * @brief Builds the parameter list of an overload, overload k takes k + 1 parameters
+ *
+ * @arg overload
+ *
+ * @return std::string
+ */
+static auto getParameters(size_t overload) -> std::string {
+  static constexpr std::array<std::string_view, 3> types = {"int", "double", "const char *"};
+  std::string parameters;
+  for (size_t i = 0; i <= overload; ++i) {
+    if (i > 0) parameters += ", ";
+    parameters += fmt::format("{} arg{}", types[i % types.size()], i);
+  }
+  return parameters;
+}
+
+/**
+ * @brief Writes the header every file of the corpus includes, with the Qt macros a run without the module falls
+ * back to
+ *
+ * @arg root
+ *
+ * @return void
+ */
+static auto writeCommonHeader(const fs::path &root) -> void {
+  std::ofstream out(root / "common.hpp");
+  out << "#pragma once\n\n"
+         "namespace bench {\n"
+         "class Base {\n"
+         " public:\n"
+         "  virtual ~Base() = default;\n"
+         "};\n"
+         "}  // namespace bench\n\n"
+         "class QObject {\n"
+         " public:\n"
+         "  virtual ~QObject() = default;\n"
+         "};\n\n"
+         "#ifndef Q_OBJECT\n"
+         "#define Q_OBJECT\n"
+         "#define Q_PROPERTY(...)\n"
+         "#define Q_INVOKABLE\n"
+         "#define signals public\n"
+         "#define slots\n"
+         "#endif\n";
+}
+
+/**
+ * @brief Writes one header of the corpus, half of the classes and a third of the functions are documented
+ *
+ * @arg path
+ * @arg root
+ * @arg fileIndex
+ * @arg shape
+ * @arg qtStyle If true, the header also holds a Qt-style class
+ *
+ * @return size_t bytes written
+ */
+static auto writeHeader(const fs::path &path, const fs::path &root, size_t fileIndex, const CorpusShape &shape,
+                        bool qtStyle) -> size_t {
+  std::string content = "#pragma once\n\n";
+  content += fmt::format("#include \"{}\"\n\n", fs::relative(root / "common.hpp", path.parent_path()).generic_string());
+  for (size_t level = 0; level < shape.depth; ++level) content += fmt::format("namespace level{} {{\n", level);
+
+  for (size_t c = 0; c < shape.classes; ++c) {
+    std::string className = fmt::format("Class{}_{}", fileIndex, c);
+    if (c % 2 == 0) content += fmt::format("/**\n * @brief {}\n */\n", className);
+    content += fmt::format("class {} : public bench::Base {{\n public:\n", className);
+    content += fmt::format("  {}();\n  ~{}() override;\n", className, className);
+    for (size_t f = 0; f < shape.functions; ++f) {
+      for (size_t o = 0; o < shape.overloads; ++o) {
+        if (f % 3 == 0) content += "  /** @brief Method */\n";
+        content += fmt::format("  int method{}({});\n", f, getParameters(o));
+      }
+    }
+    content += fmt::format(" private:\n  int member{}_ = 0;\n}};\n\n", c);
+  }
+
+  if (qtStyle) {
+    content += fmt::format(
+        "class Widget{0} : public QObject {{\n"
+        "  Q_OBJECT\n"
+        "  Q_PROPERTY(int value READ value WRITE setValue NOTIFY valueChanged)\n"
+        " public:\n"
+        "  Q_INVOKABLE int value() const;\n"
+        " public slots:\n"
+        "  void setValue(int value);\n"
+        " signals:\n"
+        "  void valueChanged(int value);\n"
+        "}};\n\n",
+        fileIndex);
+  }
+
+  content += fmt::format("enum class Kind{} {{ First, Second, Third }};\n\n", fileIndex);
+  for (size_t f = 0; f < shape.functions; ++f) {
+    for (size_t o = 0; o < shape.overloads; ++o) {
+      if (f % 3 == 0) content += "/** @brief Function */\n";
+      content += fmt::format("void function{}_{}({});\n", fileIndex, f, getParameters(o));
+    }
+  }
+
+  for (size_t level = shape.depth; level > 0; --level) content += fmt::format("}}  // namespace level{}\n", level - 1);
+  std::ofstream out(path, std::ios::binary);
+  out << content;
+  return content.size();
+}
+
+/**
+ * @brief Generates the header tree, spread over directories as deep as the namespaces with eight entries each
+ *
+ * @arg root emptied first when it holds a previous corpus, refused when it holds anything else
+ * @arg shape
+ * @arg bytes receives the size of the generated headers
+ *
+ * @return std::expected<void, std::string>
+ */
+static auto generateCorpus(const fs::path &root, const CorpusShape &shape, size_t &bytes)
+    -> std::expected<void, std::string> {
+  std::error_code ec;
+  if (fs::exists(root)) {
+    if (!fs::is_empty(root, ec) && !fs::exists(root / CorpusMarker))
+      return std::unexpected(root.string() + " is not empty and does not hold a previous corpus");
+    fs::remove_all(root, ec);
+    if (ec) return std::unexpected("Failed to empty " + root.string() + ": " + ec.message());
+  }
+  fs::create_directories(root, ec);
+  if (ec) return std::unexpected("Failed to create " + root.string() + ": " + ec.message());
+  std::ofstream(root / CorpusMarker).close();
+  writeCommonHeader(root);
+
+  bytes = 0;
+  size_t directoryDepth = std::min<size_t>(shape.depth, 3);
+  for (size_t i = 0; i < shape.files; ++i) {
+    fs::path directory = root;
+    for (size_t level = 0, rest = i; level < directoryDepth; ++level, rest /= 8)
+      directory /= fmt::format("dir{}", rest % 8);
+    fs::create_directories(directory, ec);
+    if (ec) return std::unexpected("Failed to create " + directory.string() + ": " + ec.message());
+    bool qtStyle = i % 100 < shape.qtPercent;
+    bytes += writeHeader(directory / fmt::format("header{}.hpp", i), root, i, shape, qtStyle);
+  }
+  return {};
+}
+
+/**
+ * @brief Builds the objects an older save would hold, one object in ten did not exist yet and one in seven was not
+ * documented, so the merge has additions and modifications to find
+ *
+ * @arg parsed
+ *
+ * @return std::vector<Object>
+ */
+static auto makeSavedObjects(const std::vector<Object> &parsed) -> std::vector<Object> {
+  std::vector<Object> saved;
+  saved.reserve(parsed.size());
+  for (size_t i = 0; i < parsed.size(); ++i) {
+    if (i % 10 == 0) continue;
+    const Object &obj = parsed[i];
+    if (i % 7 != 0) {
+      saved.push_back(obj);
+      continue;
+    }
+    saved.emplace_back(obj.getObjectPathView(), obj.getObjectName(), obj.getObjectScope(), obj.getObjectType(),
+                       static_cast<uint32_t>(obj.getStartLine()), static_cast<uint32_t>(obj.getStartColumn()),
+                       static_cast<uint32_t>(obj.getEndLine()), static_cast<uint32_t>(obj.getEndColumn()), "", "",
+                       obj.getArguments(), obj.getReturnType(), ObjectState::Unchanged);
+    saved.back().setOverloadIndex(obj.getOverloadIndex());
+  }
+  return saved;
+}
+
+/**
+ * @brief Gets the bytes used by a saved config and its object store
+ *
+ * @arg filesManager
+ *
+ * @return uintmax_t
+ */
+static auto getSavedBytes(const FilesManager &filesManager) -> uintmax_t {
+  std::error_code ec;
+  uintmax_t bytes = 0;
+  for (const fs::path &path : {filesManager.getConfigPath(), filesManager.getObjectStorePath(),
+                               filesManager.getSymbolIndexPath()})
+    if (fs::is_regular_file(path, ec)) bytes += fs::file_size(path, ec);
+  if (fs::is_directory(filesManager.getShardStorePath(), ec))
+    for (const auto &entry : fs::directory_iterator(filesManager.getShardStorePath(), ec))
+      if (entry.is_regular_file(ec)) bytes += entry.file_size(ec);
+  return bytes;
+}
+
+int main(int ac, char **av) {
+  cxxopts::Options options("toxidoc_bench", "Times the Toxidoc phases on a synthetic header tree");
+  options.add_options()("f,files", "Number of headers to generate", cxxopts::value<size_t>()->default_value("1000"))(
+      "classes", "Classes per header", cxxopts::value<size_t>()->default_value("4"))(
+      "functions", "Methods per class and free functions per header", cxxopts::value<size_t>()->default_value("8"))(
+      "overloads", "Overloads of every method and function", cxxopts::value<size_t>()->default_value("3"))(
+      "depth", "Namespace nesting, directories nest up to three levels", cxxopts::value<size_t>()->default_value("4"))(
+      "qt", "Percentage of headers holding a Qt-style class", cxxopts::value<size_t>()->default_value("10"))(
+      "mod", "Qt override module the headers are parsed with, empty parses them with the fallback macros",
+      cxxopts::value<std::string>()->default_value("mods/qt_override.h"))(
+      "j,jobs", "Number of worker threads (0 uses every available core)",
+      cxxopts::value<size_t>()->default_value("1"))(
+      "declarations-only", "Time the declarations-only parse profile instead of the full one",
+      cxxopts::value<bool>()->default_value("false"))(
+      "no-pch", "Do not build a precompiled header", cxxopts::value<bool>()->default_value("false"))(
+      "dir", "Directory the corpus is generated in, emptied first if it holds a previous corpus",
+      cxxopts::value<std::string>()->default_value((fs::temp_directory_path() / "toxidoc_bench").string()))(
+      "keep", "Keep the corpus after the run", cxxopts::value<bool>()->default_value("false"))("h,help",
+                                                                                              "Print usage");
+
+  cxxopts::ParseResult result;
+  try {
+    result = options.parse(ac, av);
+  } catch (const std::exception &e) {
+    std::cerr << "Error parsing options: " << e.what() << std::endl;
+    return 1;
+  }
+  if (result.count("help")) {
+    std::cout << options.help() << std::endl;
+    return 0;
+  }
+
+  // records are the only thing on stdout, logs and progress output go to stderr
+  std::ostream records(std::cout.rdbuf());
+  std::cout.rdbuf(std::cerr.rdbuf());
+  spdlog::set_default_logger(spdlog::stderr_color_mt("bench"));
+  spdlog::set_level(spdlog::level::warn);
+
+  CorpusShape shape{result["files"].as<size_t>(),    result["classes"].as<size_t>(),
+                    result["functions"].as<size_t>(), std::max<size_t>(result["overloads"].as<size_t>(), 1),
+                    result["depth"].as<size_t>(),     std::min<size_t>(result["qt"].as<size_t>(), 100)};
+  fs::path root = fs::absolute(result["dir"].as<std::string>());
+  fs::path modPath = result["mod"].as<std::string>();
+  if (!modPath.empty() && !fs::exists(modPath)) {
+    spdlog::warn("Module {} not found, Qt-style headers use the fallback macros", modPath.string());
+    modPath.clear();
+  }
+  size_t jobs = result["jobs"].as<size_t>();
+  ParseProfile profile = result["declarations-only"].as<bool>() ? ParseProfile::DeclarationsOnly : ParseProfile::Full;
+
+  json::json context = {
+      {"version", fmt::format("{}.{}.{}", TOXIDOC_VERSION_MAJOR, TOXIDOC_VERSION_MINOR, TOXIDOC_VERSION_ALTER)},
+      {"corpus_files", shape.files},
+      {"classes", shape.classes},
+      {"functions", shape.functions},
+      {"overloads", shape.overloads},
+      {"depth", shape.depth},
+      {"qt_percent", shape.qtPercent},
+      {"jobs", jobs},
+      {"profile", profile == ParseProfile::Full ? "full" : "declarations"},
+      {"pch", !result["no-pch"].as<bool>()},
+  };
+
+  size_t corpusBytes = 0;
+  std::expected<void, std::string> corpusResult;
+  Measurement measurement = measure([&]() { corpusResult = generateCorpus(root, shape, corpusBytes); });
+  if (!corpusResult) {
+    spdlog::error("Failed to generate corpus: {}", corpusResult.error());
+    return 1;
+  }
+  emitRecord(records, context, "corpus", measurement, {{"files", shape.files}, {"bytes", corpusBytes}});
+
+  const std::vector<std::string> headerExtensions = {".hpp"};
+  const std::vector<std::string> excludeDirs = {};
+  FilesManagerOptions walkOptions;
+  walkOptions.noSave = true;
+  walkOptions.modPath = modPath;
+  walkOptions.paths = {root.string()};
+  walkOptions.headerExtensions = headerExtensions;
+  walkOptions.excludeDirs = excludeDirs;
+  walkOptions.fullScan = true;
+  walkOptions.declarationsOnly = profile == ParseProfile::DeclarationsOnly;
+  FilesManager walkManager(walkOptions);
+  std::expected<void, std::string> walkResult;
+  measurement = measure([&]() { walkResult = walkManager.init(); });
+  if (!walkResult) {
+    spdlog::error("Failed to collect the corpus: {}", walkResult.error());
+    return 1;
+  }
+  const std::vector<fs::path> &files = walkManager.getSourcePaths();
+  emitRecord(records, context, "walk", measurement, {{"files", files.size()}});
+
+  ObjectsManager objectsManager({}, {}, modPath, profile);
+  if (!result["no-pch"].as<bool>()) {
+    std::expected<void, std::string> pchResult;
+    measurement = measure([&]() { pchResult = objectsManager.preparePrecompiledHeader(root / "bench.pch", {}); });
+    if (!pchResult) spdlog::warn("Precompiled header disabled: {}", pchResult.error());
+    else emitRecord(records, context, "pch", measurement, json::json::object());
+  }
+
+  std::atomic<size_t> processedFiles = 0;
+  std::vector<fs::path> failedFiles;
+  measurement = measure([&]() { failedFiles = objectsManager.processHeaderFiles(files, jobs, processedFiles); });
+  const std::vector<Object> &parsedObjects = objectsManager.getObjectsList();
+  size_t overloadedObjects = 0;
+  for (const auto &obj : parsedObjects)
+    if (obj.getOverloadIndex() > 1) overloadedObjects++;
+  emitRecord(records, context, "parse", measurement,
+             {{"files", files.size()},
+              {"cursors", objectsManager.getVisitedCursorsCount()},
+              {"objects", parsedObjects.size()},
+              {"overloaded_objects", overloadedObjects}},
+             {{"failed_files", failedFiles.size()}});
+
+  std::vector<Object> savedObjects = makeSavedObjects(parsedObjects);
+  std::vector<Object> mergedObjects;
+  measurement = measure([&]() { mergedObjects = ObjectsManager::mergeObjects(savedObjects, parsedObjects); });
+  emitRecord(records, context, "merge", measurement, {{"objects", savedObjects.size() + parsedObjects.size()}});
+
+  std::vector<std::string> sourcePaths;
+  for (const auto &path : files) sourcePaths.push_back(path.string());
+  for (const auto &[format, formatName] : StoreFormatStringMap) {
+    // the config lists the sources, as a saved one does, so no run walks the tree again
+    fs::path configPath = root / fmt::format("bench_{}.json", formatName);
+    std::ofstream(configPath) << json::json{{"source_paths", sourcePaths}}.dump();
+
+    FilesManagerOptions storeOptions;
+    storeOptions.configPath = configPath;
+    storeOptions.modPath = modPath;
+    storeOptions.headerExtensions = headerExtensions;
+    storeOptions.excludeDirs = excludeDirs;
+    storeOptions.declarationsOnly = profile == ParseProfile::DeclarationsOnly;
+    FilesManagerOptions saveOptions = storeOptions;
+    saveOptions.storeFormat = formatName;
+    FilesManager saveManager(saveOptions);
+    if (auto initResult = saveManager.init(); !initResult) {
+      spdlog::error("Failed to prepare the {} store: {}", formatName, initResult.error());
+      return 1;
+    }
+    std::expected<void, std::string> saveResult;
+    measurement = measure([&]() { saveResult = saveManager.saveConfig(mergedObjects); });
+    if (!saveResult) {
+      spdlog::error("Failed to save the {} store: {}", formatName, saveResult.error());
+      return 1;
+    }
+    emitRecord(records, context, "save_" + formatName, measurement,
+               {{"objects", mergedObjects.size()}, {"bytes", getSavedBytes(saveManager)}});
+
+    FilesManagerOptions loadOptions = storeOptions;
+    loadOptions.noSave = true;
+    FilesManager loadManager(loadOptions);
+    std::expected<void, std::string> loadResult;
+    measurement = measure([&]() { loadResult = loadManager.initSettings(); });
+    if (!loadResult) {
+      spdlog::error("Failed to load the {} store: {}", formatName, loadResult.error());
+      return 1;
+    }
+    emitRecord(records, context, "load_" + formatName, measurement,
+               {{"objects", loadManager.getSavedObjects().size()}});
+  }
+
+  size_t undocumentedObjects = 0;
+  for (const auto &obj : parsedObjects)
+    if (!obj.isValid() && obj.getRawComment().empty()) undocumentedObjects++;
+  measurement = measure([&]() { objectsManager.generateDocumentation(jobs); });
+  emitRecord(records, context, "generate", measurement, {{"files", files.size()}, {"objects", undocumentedObjects}});
+
+  if (!result["keep"].as<bool>()) {
+    std::error_code ec;
+    fs::remove_all(root, ec);
+  }
+  std::cout.rdbuf(records.rdbuf());
+  return 0;
+}
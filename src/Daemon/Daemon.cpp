@@ -0,0 +1,394 @@
+#include "Daemon.hpp"
+
+#include <spdlog/sinks/ostream_sink.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "ObjectsManager/StringPool.hpp"
+#include "Profiler/Profiler.hpp"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <signal.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+Daemon::Daemon(FilesManager &filesManager, ObjectsManager &objectsManager, bool noSave)
+    : filesManager_(filesManager), objectsManager_(objectsManager), noSave_(noSave) {}
+
+auto Daemon::getSocketPath(const fs::path &configPath) -> fs::path {
+  return configPath.parent_path() / (configPath.stem().string() + ".sock");
+}
+
+auto Daemon::getSymbolIndex() -> const SymbolIndex & {
+  if (!symbolIndex_) symbolIndex_ = SymbolIndex::build(objectsManager_.getObjectsList());
+  return symbolIndex_.value();
+}
+
+#if defined(__linux__)
+
+/**
+ * @brief Fills a Unix socket address
+ *
+ * @arg socketPath
+ * @arg address
+ *
+ * @return std::expected<void, std::string>
+ */
+static auto makeAddress(const fs::path &socketPath, sockaddr_un &address) -> std::expected<void, std::string> {
+  std::string path = socketPath.string();
+  if (path.size() >= sizeof(address.sun_path)) return std::unexpected("Socket path is too long: " + path);
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return {};
+}
+
+/**
+ * @brief Writes the whole buffer to a socket, a client gone in between does not raise SIGPIPE
+ *
+ * @arg fd
+ * @arg data
+ *
+ * @return bool
+ */
+static auto sendAll(int fd, std::string_view data) -> bool {
+  while (!data.empty()) {
+    ssize_t written = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+    data.remove_prefix(static_cast<size_t>(written));
+  }
+  return true;
+}
+
+/**
+ * @brief Tells if a path is a directory or lies under it, comparing whole components
+ *
+ * @arg path
+ * @arg directory
+ *
+ * @return bool
+ */
+static auto isInside(const fs::path &path, const fs::path &directory) -> bool {
+  auto [directoryEnd, pathEnd] = std::mismatch(directory.begin(), directory.end(), path.begin(), path.end());
+  return directoryEnd == directory.end();
+}
+
+Daemon::~Daemon() {
+  if (socketFd_ >= 0) {
+    close(socketFd_);
+    std::error_code ec;
+    fs::remove(socketPath_, ec);
+  }
+  if (inotifyFd_ >= 0) close(inotifyFd_);
+  if (signalFd_ >= 0) close(signalFd_);
+}
+
+auto Daemon::openSocket() -> std::expected<void, std::string> {
+  socketPath_ = getSocketPath(filesManager_.getConfigPath());
+  sockaddr_un address;
+  auto addressResult = makeAddress(socketPath_, address);
+  if (!addressResult) return addressResult;
+
+  if (fs::exists(socketPath_)) {
+    if (sendRequest(socketPath_, {{"command", "ping"}}))
+      return std::unexpected("A daemon is already serving " + socketPath_.string());
+    // left behind by a daemon that did not exit cleanly
+    std::error_code ec;
+    fs::remove(socketPath_, ec);
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return std::unexpected(std::string("Failed to create socket: ") + std::strerror(errno));
+  if (bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, 16) != 0) {
+    std::string error = std::strerror(errno);
+    close(fd);
+    return std::unexpected("Failed to listen on " + socketPath_.string() + ": " + error);
+  }
+  socketFd_ = fd;
+  return {};
+}
+
+auto Daemon::addWatch(const fs::path &directory) -> void {
+  constexpr uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE | IN_ONLYDIR;
+  int wd = inotify_add_watch(inotifyFd_, directory.c_str(), mask);
+  if (wd < 0) {
+    spdlog::warn("Failed to watch {}: {}", directory.string(), std::strerror(errno));
+    return;
+  }
+  watchedDirectories_[wd] = directory;
+}
+
+auto Daemon::addDirectory(const fs::path &directory, bool queueHeaders) -> void {
+  addWatch(directory);
+  // a directory moved in or created with its content is not announced file by file
+  std::error_code ec;
+  for (auto it = fs::recursive_directory_iterator(directory, ec); !ec && it != fs::recursive_directory_iterator();
+       it.increment(ec)) {
+    std::error_code typeEc;
+    if (it->is_directory(typeEc) && !it->is_symlink(typeEc)) {
+      if (filesManager_.acceptsPath(it->path(), true)) addWatch(it->path());
+      else it.disable_recursion_pending();
+    } else if (queueHeaders && it->is_regular_file(typeEc) && filesManager_.acceptsPath(it->path(), false)) {
+      changedFiles_.insert(it->path().string());
+    }
+  }
+}
+
+auto Daemon::removeDirectory(const fs::path &directory) -> void {
+  // the watches go away with an IN_IGNORED event each, a directory moved out keeps them until they are removed
+  for (const auto &[wd, watched] : watchedDirectories_)
+    if (isInside(watched, directory)) inotify_rm_watch(inotifyFd_, wd);
+  std::erase_if(changedFiles_, [&directory](const std::string &file) { return isInside(file, directory); });
+  for (const auto &path : filesManager_.getSourcePaths())
+    if (isInside(path, directory)) removedFiles_.insert(path.string());
+}
+
+auto Daemon::readEvents() -> void {
+  alignas(inotify_event) char buffer[64 * 1024];
+  for (;;) {
+    ssize_t length = read(inotifyFd_, buffer, sizeof(buffer));
+    if (length <= 0) break;
+    for (char *ptr = buffer; ptr < buffer + length;) {
+      const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+      ptr += sizeof(inotify_event) + event->len;
+      if (event->mask & IN_Q_OVERFLOW) {
+        // events were lost, every source is checked again, the unchanged ones are skipped by their fingerprint
+        spdlog::warn("Watch queue overflowed, checking every source file");
+        for (const auto &path : filesManager_.getSourcePaths()) changedFiles_.insert(path.string());
+        continue;
+      }
+      auto directory = watchedDirectories_.find(event->wd);
+      if (directory == watchedDirectories_.end()) continue;
+      if (event->mask & IN_IGNORED) {
+        watchedDirectories_.erase(directory);
+        continue;
+      }
+      if (event->len == 0) continue;
+      fs::path path = directory->second / event->name;
+      if (event->mask & IN_ISDIR) {
+        if (event->mask & (IN_DELETE | IN_MOVED_FROM)) removeDirectory(path);
+        else if (event->mask & (IN_CREATE | IN_MOVED_TO) && filesManager_.acceptsPath(path, true))
+          addDirectory(path, true);
+        continue;
+      }
+      if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        changedFiles_.erase(path.string());
+        removedFiles_.insert(path.string());
+      } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        removedFiles_.erase(path.string());
+        changedFiles_.insert(path.string());
+      }
+    }
+  }
+}
+
+auto Daemon::applyChanges() -> void {
+  if (changedFiles_.empty() && removedFiles_.empty()) return;
+  ScopedTimer timer("phase", "reparse");
+  size_t removedCount = 0;
+  size_t parsedCount = 0;
+  for (const auto &file : removedFiles_) {
+    if (!filesManager_.removeSourceFile(file)) continue;
+    objectsManager_.replaceFileObjects(file, {});
+    objectsManager_.discardTranslationUnit(file);
+    removedCount++;
+  }
+  for (const auto &file : changedFiles_) {
+    // a save rewriting the same content, or a file that is not a header, costs no parse
+    if (!filesManager_.acceptsPath(file, false) || !filesManager_.updateSourceFile(file)) continue;
+    std::vector<Object> objects;
+    auto parseResult = objectsManager_.parseHeaderFileInSlot(0, file, objects);
+    if (!parseResult) {
+      spdlog::error("Error processing file {}: {}", file, parseResult.error());
+      filesManager_.invalidateFingerprint(file);
+      continue;
+    }
+    objectsManager_.replaceFileObjects(file, std::move(objects));
+    parsedCount++;
+  }
+  changedFiles_.clear();
+  removedFiles_.clear();
+  if (parsedCount == 0 && removedCount == 0) return;
+
+  symbolIndex_.reset();
+  spdlog::info("Reparsed {} changed files, dropped {} removed files", parsedCount, removedCount);
+  if (++appliedBatches_ % CompactionInterval == 0) {
+    size_t arenaBytes = StringPool::global().getArenaBytes();
+    objectsManager_.compactStrings();
+    spdlog::info("Compacted strings from {:.2f} MB to {:.2f} MB", arenaBytes / (1024.0 * 1024.0),
+                 StringPool::global().getArenaBytes() / (1024.0 * 1024.0));
+  }
+  if (noSave_) return;
+  auto saveResult = filesManager_.saveConfig(objectsManager_.getObjectsList());
+  if (!saveResult) spdlog::error("Failed to save config: {}", saveResult.error());
+}
+
+auto Daemon::serveConnection(int connection, const RequestHandler &handler) -> void {
+  std::string line;
+  char buffer[4096];
+  auto deadline = std::chrono::steady_clock::now() + RequestTimeout;
+  while (line.find('\n') == std::string::npos) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    pollfd pending{connection, POLLIN, 0};
+    if (remaining.count() <= 0 || poll(&pending, 1, static_cast<int>(remaining.count())) <= 0) {
+      spdlog::warn("Dropping a client that sent no request");
+      return;
+    }
+    ssize_t length = read(connection, buffer, sizeof(buffer));
+    if (length <= 0) break;
+    line.append(buffer, static_cast<size_t>(length));
+  }
+
+  json::json request = json::json::parse(line.substr(0, line.find('\n')), nullptr, false);
+  json::json response;
+  if (request.is_discarded() || !request.is_object()) {
+    response = {{"status", 1}, {"output", "Invalid request\n"}};
+  } else if (request.value("command", "") == "ping") {
+    response = {{"status", 0}, {"output", ""}};
+  } else {
+    // the client sees what a run in its own terminal would have printed
+    std::ostringstream output;
+    auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(output);
+    auto logger = spdlog::default_logger();
+    logger->sinks().push_back(sink);
+    std::streambuf *console = std::cout.rdbuf(output.rdbuf());
+    int status = 1;
+    try {
+      status = handler(request);
+    } catch (const std::exception &e) {
+      spdlog::error("Failed to answer request: {}", e.what());
+    }
+    std::cout.flush();
+    std::cout.rdbuf(console);
+    logger->sinks().pop_back();
+    response = {{"status", status}, {"output", output.str()}};
+  }
+  sendAll(connection, response.dump(-1, ' ', false, json::json::error_handler_t::replace) + "\n");
+}
+
+auto Daemon::run(const RequestHandler &handler) -> std::expected<void, std::string> {
+  // blocked before any thread is started so every thread leaves them to the signal descriptor
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+  signalFd_ = signalfd(-1, &signals, SFD_CLOEXEC);
+  if (signalFd_ < 0) return std::unexpected(std::string("Failed to create signal descriptor: ") + std::strerror(errno));
+
+  inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotifyFd_ < 0) return std::unexpected(std::string("Failed to initialize inotify: ") + std::strerror(errno));
+  std::set<fs::path> directories;
+  const auto &roots = filesManager_.getSourceRoots();
+  if (roots.empty()) {
+    // a config saved before the roots were recorded only tells where its sources are
+    for (const auto &path : filesManager_.getSourcePaths()) {
+      fs::path directory = path.parent_path();
+      directories.insert(directory.empty() ? fs::path(".") : directory);
+    }
+  }
+  for (const auto &root : roots) {
+    std::error_code ec;
+    if (fs::is_directory(root, ec)) {
+      addDirectory(root, false);
+    } else {
+      fs::path directory = root.parent_path();
+      directories.insert(directory.empty() ? fs::path(".") : directory);
+    }
+  }
+  for (const auto &directory : directories) addWatch(directory);
+
+  auto socketResult = openSocket();
+  if (!socketResult) return socketResult;
+
+  // only the headers edited from now on keep a translation unit, the working set stays small
+  objectsManager_.setRetainTranslationUnits(true);
+  // every save writes the states a one-shot run would, then the saved objects go, compaction would leave them dangling
+  objectsManager_.mergeSavedObjects(filesManager_.getSavedObjects());
+  filesManager_.dropSavedObjects();
+  objectsManager_.prepareWorkerSlots(1);
+  if (!noSave_) {
+    auto saveResult = filesManager_.saveConfig(objectsManager_.getObjectsList());
+    if (!saveResult) spdlog::error("Failed to save config: {}", saveResult.error());
+  }
+  spdlog::info("Watching {} directories, serving requests on {}", watchedDirectories_.size(), socketPath_.string());
+
+  pollfd descriptors[3] = {{signalFd_, POLLIN, 0}, {inotifyFd_, POLLIN, 0}, {socketFd_, POLLIN, 0}};
+  for (;;) {
+    bool pendingChanges = !changedFiles_.empty() || !removedFiles_.empty();
+    int ready = poll(descriptors, 3, pendingChanges ? static_cast<int>(SettleDelay.count()) : -1);
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      return std::unexpected(std::string("Failed to wait for events: ") + std::strerror(errno));
+    }
+    if (ready == 0) {
+      applyChanges();
+      continue;
+    }
+    if (descriptors[0].revents & POLLIN) {
+      spdlog::info("Daemon stopping");
+      return {};
+    }
+    if (descriptors[1].revents & POLLIN) readEvents();
+    if (descriptors[2].revents & POLLIN) {
+      int connection = accept4(socketFd_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (connection < 0) continue;
+      // a request sees every change written before it was sent
+      readEvents();
+      applyChanges();
+      serveConnection(connection, handler);
+      close(connection);
+    }
+  }
+}
+
+auto Daemon::sendRequest(const fs::path &socketPath, const json::json &request)
+    -> std::expected<json::json, std::string> {
+  sockaddr_un address;
+  auto addressResult = makeAddress(socketPath, address);
+  if (!addressResult) return std::unexpected(addressResult.error());
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return std::unexpected(std::string("Failed to create socket: ") + std::strerror(errno));
+  if (connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+    close(fd);
+    return std::unexpected("No daemon is serving " + socketPath.string() + ", start one with --daemon");
+  }
+
+  std::string data;
+  bool sent = sendAll(fd, request.dump(-1, ' ', false, json::json::error_handler_t::replace) + "\n");
+  char buffer[64 * 1024];
+  ssize_t length = 0;
+  while (sent && (length = read(fd, buffer, sizeof(buffer))) != 0) {
+    if (length < 0 && errno == EINTR) continue;
+    if (length < 0) break;
+    data.append(buffer, static_cast<size_t>(length));
+  }
+  close(fd);
+
+  json::json response = json::json::parse(data, nullptr, false);
+  if (response.is_discarded() || !response.is_object()) return std::unexpected("Invalid response from the daemon");
+  return response;
+}
+
+#else
+
+Daemon::~Daemon() = default;
+
+auto Daemon::run(const RequestHandler &) -> std::expected<void, std::string> {
+  return std::unexpected("Daemon mode relies on inotify, it is only available on Linux");
+}
+
+auto Daemon::sendRequest(const fs::path &, const json::json &) -> std::expected<json::json, std::string> {
+  return std::unexpected("Daemon mode relies on inotify, it is only available on Linux");
+}
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef DAEMON_HPP_
+#define DAEMON_HPP_
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include "FilesManager/FilesManager.hpp"
+#include "FilesManager/SymbolIndex.hpp"
+#include "ObjectsManager/ObjectsManager.hpp"
+
+namespace fs = std::filesystem;
+namespace json = nlohmann;
+
+/**
+ * @brief Resident process keeping the sources, their objects and the translation units of edited headers in memory
+ *
+ * The roots the sources were collected from are watched recursively with inotify, a header written, moved in or
+ * deleted is reparsed or dropped once the tree settles, reusing its retained translation unit, a directory moved out
+ * or deleted drops every header under it. The strings of the objects are compacted every few batches of changes so
+ * that the pool only holds what the current objects use. Requests are JSON lines read from a Unix
+ * socket next to the config, the output the handler prints is sent back with its exit code. Linux only
+ *
+ * @class Daemon
+ */
+class Daemon {
+ public:
+  /**
+   * @brief Answers a request, prints its output and returns its exit code
+   */
+  using RequestHandler = std::function<int(const json::json &request)>;
+
+  /**
+   * @brief Constructs a Daemon
+   *
+   * @arg filesManager sources must already be collected
+   * @arg objectsManager objects of every source must already be there
+   * @arg noSave If true, the config is not saved after the changed headers are reparsed
+   */
+  Daemon(FilesManager &filesManager, ObjectsManager &objectsManager, bool noSave);
+
+  Daemon(const Daemon &) = delete;
+  auto operator=(const Daemon &) -> Daemon & = delete;
+
+  /**
+   * @brief Destructor for Daemon, closes the watches and removes the socket
+   */
+  ~Daemon();
+
+  /**
+   * @brief Gets the path of the socket of the daemon serving a config
+   *
+   * @arg configPath
+   *
+   * @return fs::path
+   */
+  static auto getSocketPath(const fs::path &configPath) -> fs::path;
+
+  /**
+   * @brief Watches the sources and serves requests until SIGINT or SIGTERM
+   *
+   * @arg handler called for each request, with the objects up to date with every change made before the request
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto run(const RequestHandler &handler) -> std::expected<void, std::string>;
+
+  /**
+   * @brief Gets the name index of the current objects, rebuilt after a change
+   *
+   * @return const SymbolIndex &
+   */
+  auto getSymbolIndex() -> const SymbolIndex &;
+
+  /**
+   * @brief Sends a request to a daemon and waits for its response
+   *
+   * @arg socketPath
+   * @arg request
+   *
+   * @return std::expected<json::json, std::string> response holding "status" and "output"
+   */
+  static auto sendRequest(const fs::path &socketPath, const json::json &request)
+      -> std::expected<json::json, std::string>;
+
+ private:
+  // quiet time after the last event before changes are applied, a save writes several files in a row
+  static constexpr std::chrono::milliseconds SettleDelay{100};
+  // time a client has to send its request
+  static constexpr std::chrono::milliseconds RequestTimeout{1000};
+  // applied batches between two compactions of the string pool, replaced objects leave their strings behind
+  static constexpr size_t CompactionInterval = 64;
+
+  /**
+   * @brief Creates the socket, a socket left by a daemon that is gone is replaced
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto openSocket() -> std::expected<void, std::string>;
+
+  /**
+   * @brief Watches a directory
+   *
+   * @arg directory
+   *
+   * @return void
+   */
+  auto addWatch(const fs::path &directory) -> void;
+
+  /**
+   * @brief Watches a directory and the accepted directories under it, the directory itself is not checked
+   *
+   * @arg directory
+   * @arg queueHeaders If true, the headers found under it are queued, for a directory that appeared with its content
+   *
+   * @return void
+   */
+  auto addDirectory(const fs::path &directory, bool queueHeaders) -> void;
+
+  /**
+   * @brief Stops watching a directory that is gone and queues the removal of every source under it
+   *
+   * @arg directory
+   *
+   * @return void
+   */
+  auto removeDirectory(const fs::path &directory) -> void;
+
+  /**
+   * @brief Reads the pending inotify events without blocking and queues the files they touch
+   *
+   * @return void
+   */
+  auto readEvents() -> void;
+
+  /**
+   * @brief Reparses the queued changed headers and drops the queued removed ones
+   *
+   * @return void
+   */
+  auto applyChanges() -> void;
+
+  /**
+   * @brief Reads a request from a client, answers it and sends the response
+   *
+   * @arg connection
+   * @arg handler
+   *
+   * @return void
+   */
+  auto serveConnection(int connection, const RequestHandler &handler) -> void;
+
+  FilesManager &filesManager_;
+  ObjectsManager &objectsManager_;
+  bool noSave_;
+  int inotifyFd_ = -1;
+  int socketFd_ = -1;
+  int signalFd_ = -1;
+  fs::path socketPath_;
+  std::unordered_map<int, fs::path> watchedDirectories_;
+  std::set<std::string> changedFiles_;
+  std::set<std::string> removedFiles_;
+  size_t appliedBatches_ = 0;
+  std::optional<SymbolIndex> symbolIndex_;
+};
+
+#endif /* !DAEMON_HPP_ */
@@ -0,0 +1,86 @@
+#include "DocWriter.hpp"
+
+#include <algorithm>
+
+#include "FilesManager/AtomicFile.hpp"
+#include "FilesManager/MappedFile.hpp"
+#include "Profiler/AllocationTracker.hpp"
+
+DocWriter::DocWriter(size_t jobs) : jobs_(jobs) {
+  if (jobs_ == 0) jobs_ = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+auto DocWriter::addInsertion(const fs::path &filePath, size_t line, size_t column, std::string text) -> void {
+  insertionsByFile_[filePath.string()].push_back({line, column, std::move(text)});
+}
+
+auto DocWriter::flush() -> size_t {
+  std::vector<const std::pair<const std::string, std::vector<DocInsertion>> *> files;
+  for (const auto &entry : insertionsByFile_) files.push_back(&entry);
+
+  std::vector<std::string> errors(files.size());
+  std::atomic<size_t> nextFile = 0;
+  auto worker = [&]() {
+    AllocationScope allocationScope(Subsystem::Generate);
+    for (size_t i = nextFile++; i < files.size(); i = nextFile++) {
+      auto writeResult = writeFile(files[i]->first, files[i]->second);
+      if (!writeResult) errors[i] = writeResult.error();
+    }
+  };
+  {
+    std::vector<std::jthread> workers;
+    for (size_t i = 1; i < std::min(jobs_, files.size()); ++i) workers.emplace_back(worker);
+    worker();
+  }
+
+  size_t written = 0;
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (!errors[i].empty()) {
+      spdlog::error("Failed to write documentation for file {}: {}", files[i]->first, errors[i]);
+      continue;
+    }
+    written += files[i]->second.size();
+  }
+  insertionsByFile_.clear();
+  return written;
+}
+
+auto DocWriter::writeFile(const fs::path &filePath, const std::vector<DocInsertion> &insertions)
+    -> std::expected<void, std::string> {
+  auto mapResult = MappedFile::open(filePath);
+  if (!mapResult) return std::unexpected(mapResult.error());
+  std::string_view content = mapResult->view();
+
+  std::vector<size_t> lineStarts = {0};
+  for (size_t pos = content.find('\n'); pos != std::string_view::npos; pos = content.find('\n', pos + 1))
+    lineStarts.push_back(pos + 1);
+
+  // sorted by descending offset, ties keep queue order so the last queued block lands first once applied
+  std::vector<std::pair<size_t, const DocInsertion *>> offsets;
+  size_t insertedSize = 0;
+  for (const auto &insertion : insertions) {
+    if (insertion.line == 0 || insertion.line > lineStarts.size())
+      return std::unexpected("Insertion line out of range");
+    size_t column = std::max<size_t>(insertion.column, 1);
+    size_t offset = std::min(lineStarts[insertion.line - 1] + column - 1, content.size());
+    offsets.emplace_back(offset, &insertion);
+    insertedSize += insertion.text.size();
+  }
+  std::stable_sort(offsets.begin(), offsets.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+  // filled from the end, each original chunk and its block are copied exactly once
+  std::string output(content.size() + insertedSize, '\0');
+  size_t outputEnd = output.size();
+  size_t contentEnd = content.size();
+  for (const auto &[offset, insertion] : offsets) {
+    size_t chunkSize = contentEnd - offset;
+    outputEnd -= chunkSize;
+    content.copy(output.data() + outputEnd, chunkSize, offset);
+    outputEnd -= insertion->text.size();
+    insertion->text.copy(output.data() + outputEnd, insertion->text.size());
+    contentEnd = offset;
+  }
+  content.copy(output.data(), contentEnd, 0);
+
+  return AtomicFile::write(filePath, output, true);
+}
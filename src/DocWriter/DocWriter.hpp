@@ -0,0 +1,83 @@
+#ifndef DOCWRITER_HPP_
+#define DOCWRITER_HPP_
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <expected>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Documentation block to insert before a recorded object location
+ *
+ * @struct DocInsertion
+ */
+struct DocInsertion {
+  size_t line;
+  size_t column;
+  std::string text;
+};
+
+/**
+ * @brief Writes documentation stubs into headers without Clang, from the insertion points recorded during the scan
+ *
+ * @class DocWriter
+ */
+class DocWriter {
+ public:
+  /**
+   * @brief Constructs a DocWriter
+   *
+   * @arg jobs number of files written concurrently, 0 uses every available core
+   */
+  explicit DocWriter(size_t jobs = 1);
+
+  /**
+   * @brief Destructor for DocWriter
+   */
+  ~DocWriter() = default;
+
+  /**
+   * @brief Queues a documentation block before the given 1-based line and byte column of a file
+   *
+   * @arg filePath
+   * @arg line
+   * @arg column
+   * @arg text
+   *
+   * @return void
+   */
+  auto addInsertion(const fs::path &filePath, size_t line, size_t column, std::string text) -> void;
+
+  /**
+   * @brief Writes every queued file, files are processed in parallel and each one is replaced atomically
+   *
+   * @return size_t number of insertions written
+   */
+  auto flush() -> size_t;
+
+ private:
+  /**
+   * @brief Maps a file, applies its insertions from the bottom of the file up and replaces it with a single write
+   *
+   * Insertions sharing a location keep the Clang rewriter order, the last queued one ends up first
+   *
+   * @arg filePath
+   * @arg insertions
+   *
+   * @return std::expected<void, std::string>
+   */
+  static auto writeFile(const fs::path &filePath, const std::vector<DocInsertion> &insertions)
+      -> std::expected<void, std::string>;
+
+  size_t jobs_;
+  std::map<std::string, std::vector<DocInsertion>> insertionsByFile_;
+};
+
+#endif /* !DOCWRITER_HPP_ */
@@ -0,0 +1,96 @@
+#include "AtomicFile.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <random>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// a name taken by a leftover file is skipped, past this many the directory is assumed unwritable
+constexpr size_t MaxTempAttempts = 16;
+
+/**
+ * @brief Gets a tag telling this process apart from the others writing next to the same file
+ *
+ * @return std::string
+ */
+static auto getProcessTag() -> std::string {
+#if !defined(_WIN32)
+  return std::to_string(::getpid());
+#else
+  static const std::string tag = std::to_string(std::random_device{}());
+  return tag;
+#endif
+}
+
+AtomicFile::AtomicFile(fs::path targetPath, bool keepPermissions)
+    : targetPath_(std::move(targetPath)), keepPermissions_(keepPermissions) {}
+
+AtomicFile::~AtomicFile() {
+  if (!out_.is_open()) return;
+  out_.close();
+  std::error_code ec;
+  fs::remove(tempPath_, ec);
+}
+
+auto AtomicFile::open(char *buffer, size_t bufferSize) -> std::expected<void, std::string> {
+  static std::atomic<uint64_t> tempCounter = 0;
+  for (size_t attempt = 0; attempt < MaxTempAttempts; ++attempt) {
+    tempPath_ = targetPath_;
+    tempPath_ += "." + getProcessTag() + "." + std::to_string(tempCounter++) + ".toxidoc.tmp";
+#if !defined(_WIN32)
+    // created exclusively, the name belongs to this writer until it is renamed or removed
+    int fd = ::open(tempPath_.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (fd < 0 && errno == EEXIST) continue;
+    if (fd < 0) return std::unexpected("Failed to create " + tempPath_.string());
+    ::close(fd);
+#else
+    if (fs::exists(tempPath_)) continue;
+#endif
+    // the buffer has to be installed before the file is opened to be taken into account
+    if (buffer) out_.rdbuf()->pubsetbuf(buffer, static_cast<std::streamsize>(bufferSize));
+    out_.open(tempPath_, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+      std::error_code ec;
+      fs::remove(tempPath_, ec);
+      return std::unexpected("Failed to open " + tempPath_.string() + " for writing");
+    }
+    return {};
+  }
+  return std::unexpected("Failed to find a free temporary file name next to " + targetPath_.string());
+}
+
+auto AtomicFile::stream() -> std::ofstream & { return out_; }
+
+auto AtomicFile::commit() -> std::expected<void, std::string> {
+  if (!out_.is_open()) return std::unexpected(targetPath_.string() + " was not opened for writing");
+  out_.close();
+  std::error_code ec;
+  if (!out_) {
+    fs::remove(tempPath_, ec);
+    return std::unexpected("Failed to write " + targetPath_.string());
+  }
+  if (keepPermissions_) {
+    auto status = fs::status(targetPath_, ec);
+    if (!ec) fs::permissions(tempPath_, status.permissions(), ec);
+  }
+  fs::rename(tempPath_, targetPath_, ec);
+  if (ec) {
+    std::error_code removeEc;
+    fs::remove(tempPath_, removeEc);
+    return std::unexpected("Failed to replace " + targetPath_.string() + ": " + ec.message());
+  }
+  return {};
+}
+
+auto AtomicFile::write(const fs::path &targetPath, std::string_view data, bool keepPermissions)
+    -> std::expected<void, std::string> {
+  AtomicFile file(targetPath, keepPermissions);
+  auto openResult = file.open();
+  if (!openResult) return openResult;
+  file.stream().write(data.data(), static_cast<std::streamsize>(data.size()));
+  return file.commit();
+}
@@ -0,0 +1,82 @@
+#ifndef ATOMICFILE_HPP_
+#define ATOMICFILE_HPP_
+
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Replaces a file as a whole, the content is written to a temporary file next to the target and renamed over
+ * it by commit(), a reader never sees a partial file and a failed write leaves the previous one untouched
+ *
+ * Temporary files are named after the process and a counter and created exclusively, so several runs replacing the
+ * same file never write to the same temporary file, the last rename wins
+ *
+ * @class AtomicFile
+ */
+class AtomicFile {
+ public:
+  /**
+   * @brief Constructs an AtomicFile, nothing is created before open()
+   *
+   * @arg targetPath path of the file to replace
+   * @arg keepPermissions if true, the replaced file keeps the permissions of the previous one
+   */
+  AtomicFile(fs::path targetPath, bool keepPermissions = false);
+
+  /**
+   * @brief Destructor for AtomicFile, drops the temporary file if commit() was never reached
+   */
+  ~AtomicFile();
+
+  AtomicFile(const AtomicFile &) = delete;
+  auto operator=(const AtomicFile &) -> AtomicFile & = delete;
+
+  /**
+   * @brief Creates the temporary file, under a name no other writer uses
+   *
+   * @arg buffer optional stream buffer, it has to outlive the file
+   * @arg bufferSize
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto open(char *buffer = nullptr, size_t bufferSize = 0) -> std::expected<void, std::string>;
+
+  /**
+   * @brief gets the stream writing the temporary file
+   *
+   * @return std::ofstream &
+   */
+  auto stream() -> std::ofstream &;
+
+  /**
+   * @brief Flushes the temporary file and renames it over the target, the temporary file is removed on failure
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto commit() -> std::expected<void, std::string>;
+
+  /**
+   * @brief Replaces a file with the given content
+   *
+   * @arg targetPath
+   * @arg data
+   * @arg keepPermissions if true, the replaced file keeps the permissions of the previous one
+   *
+   * @return std::expected<void, std::string>
+   */
+  static auto write(const fs::path &targetPath, std::string_view data, bool keepPermissions = false)
+      -> std::expected<void, std::string>;
+
+ private:
+  fs::path targetPath_;
+  fs::path tempPath_;
+  bool keepPermissions_;
+  std::ofstream out_;
+};
+
+#endif /* !ATOMICFILE_HPP_ */
@@ -0,0 +1,233 @@
+#include "CompilationDatabase.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <map>
+#include <nlohmann/json.hpp>
+
+namespace json = nlohmann;
+
+namespace {
+
+// flags taking a path, either joined (-Iinclude) or as the next argument (-I include)
+constexpr std::array PathFlags = {"-I",       "-isystem", "-iquote",   "-idirafter", "-iframework",
+                                  "-F",       "-include", "-imacros",  "-isysroot",  "--sysroot"};
+// flags taking a value that is not a path
+constexpr std::array ValueFlags = {"-D", "-U", "-target"};
+// flags kept as they are
+constexpr std::array PrefixFlags = {"-std=",     "--std=",          "-stdlib=",           "--target=", "-nostdinc",
+                                    "-m32",      "-fms-extensions", "-fms-compatibility", "-m64"};
+
+/**
+ * @brief Makes a path absolute against the directory of an entry, a missing forced include is left to the search path
+ */
+auto resolvePath(const std::string &flag, const std::string &value, const fs::path &directory) -> std::string {
+  fs::path path(value);
+  if (path.is_absolute() || value.empty()) return value;
+  fs::path resolved = (directory / path).lexically_normal();
+  if ((flag == "-include" || flag == "-imacros") && !fs::exists(resolved)) return value;
+  return resolved.string();
+}
+
+}  // namespace
+
+auto CompilationDatabase::splitCommand(const std::string &command) -> std::vector<std::string> {
+  std::vector<std::string> arguments;
+  std::string current;
+  bool inArgument = false;
+  char quote = '\0';
+  for (size_t i = 0; i < command.size(); ++i) {
+    char c = command[i];
+    if (quote == '\'') {
+      if (c == '\'') quote = '\0';
+      else current += c;
+    } else if (quote == '"') {
+      if (c == '"') {
+        quote = '\0';
+      } else if (c == '\\' && i + 1 < command.size() && (command[i + 1] == '"' || command[i + 1] == '\\')) {
+        current += command[++i];
+      } else {
+        current += c;
+      }
+    } else if (c == '\'' || c == '"') {
+      quote = c;
+      inArgument = true;
+    } else if (c == '\\' && i + 1 < command.size()) {
+      current += command[++i];
+      inArgument = true;
+    } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      if (inArgument) arguments.push_back(std::move(current));
+      current.clear();
+      inArgument = false;
+    } else {
+      current += c;
+      inArgument = true;
+    }
+  }
+  if (inArgument) arguments.push_back(std::move(current));
+  return arguments;
+}
+
+auto CompilationDatabase::extractFlags(const std::vector<std::string> &arguments, const fs::path &directory)
+    -> std::vector<std::string> {
+  std::vector<std::string> flags;
+  // the first argument is the compiler
+  for (size_t i = 1; i < arguments.size(); ++i) {
+    const std::string &arg = arguments[i];
+    bool matched = false;
+
+    for (std::string_view flag : PathFlags) {
+      if (!arg.starts_with(flag)) continue;
+      std::string value;
+      if (arg.size() == flag.size()) {
+        if (i + 1 >= arguments.size()) break;
+        value = arguments[++i];
+      } else if (flag == "--sysroot" && arg[flag.size()] == '=') {
+        value = arg.substr(flag.size() + 1);
+      } else if (flag.size() == 2 || flag == "-isystem" || flag == "-iquote" || flag == "-idirafter") {
+        // only the short flags and the include directory flags accept a joined value
+        value = arg.substr(flag.size());
+      } else {
+        continue;
+      }
+      std::string flagStr(flag);
+      flags.push_back(flagStr);
+      flags.push_back(resolvePath(flagStr, value, directory));
+      matched = true;
+      break;
+    }
+    if (matched) continue;
+
+    for (std::string_view flag : ValueFlags) {
+      if (!arg.starts_with(flag)) continue;
+      if (arg.size() == flag.size()) {
+        if (i + 1 >= arguments.size()) break;
+        flags.push_back(arg);
+        flags.push_back(arguments[++i]);
+      } else if (flag.size() == 2) {
+        flags.push_back(arg);
+      } else {
+        continue;
+      }
+      matched = true;
+      break;
+    }
+    if (matched) continue;
+
+    for (std::string_view flag : PrefixFlags) {
+      if (!arg.starts_with(flag)) continue;
+      flags.push_back(arg);
+      break;
+    }
+  }
+  return flags;
+}
+
+auto CompilationDatabase::internFlagSet(std::vector<std::string> flags) -> size_t {
+  std::string key;
+  for (const auto &flag : flags) {
+    key += flag;
+    key += '\0';
+  }
+  auto [it, inserted] = flagSetIndexes_.emplace(std::move(key), flagSets_.size());
+  if (inserted) flagSets_.push_back(std::move(flags));
+  return it->second;
+}
+
+auto CompilationDatabase::load(const fs::path &path) -> std::expected<CompilationDatabase, std::string> {
+  fs::path databasePath = fs::is_directory(path) ? path / "compile_commands.json" : path;
+  std::ifstream databaseFile(databasePath, std::ios::binary);
+  if (!databaseFile.is_open()) return std::unexpected("Failed to open compilation database " + databasePath.string());
+  json::json entries = json::json::parse(databaseFile, nullptr, false);
+  if (entries.is_discarded() || !entries.is_array()) return std::unexpected("Failed to parse compilation database");
+
+  CompilationDatabase database;
+  // sorted so the entry picked for a directory does not depend on the order of the database
+  std::map<std::string, std::vector<DirectoryEntry>> entriesByDirectory;
+  for (const auto &entry : entries) {
+    if (!entry.is_object() || !entry.contains("file") || !entry["file"].is_string()) continue;
+    fs::path directory = entry.contains("directory") && entry["directory"].is_string()
+                             ? fs::path(entry["directory"].get<std::string>())
+                             : databasePath.parent_path();
+    directory = fs::absolute(directory).lexically_normal();
+    fs::path file = entry["file"].get<std::string>();
+    if (file.is_relative()) file = directory / file;
+    file = file.lexically_normal();
+
+    std::vector<std::string> arguments;
+    if (entry.contains("arguments") && entry["arguments"].is_array()) {
+      for (const auto &arg : entry["arguments"])
+        if (arg.is_string()) arguments.push_back(arg.get<std::string>());
+    } else if (entry.contains("command") && entry["command"].is_string()) {
+      arguments = splitCommand(entry["command"].get<std::string>());
+    } else {
+      continue;
+    }
+
+    std::vector<std::string> flags = extractFlags(arguments, directory);
+    database.addToDigest(file.string());
+    for (const auto &flag : flags) database.addToDigest(flag);
+    size_t flagSet = database.internFlagSet(std::move(flags));
+    database.flagSetByFile_.emplace(file.string(), flagSet);
+    entriesByDirectory[file.parent_path().string()].push_back(
+        {file.filename().string(), file.stem().string(), flagSet});
+    database.entriesCount_++;
+  }
+  if (database.entriesCount_ == 0) return std::unexpected("Compilation database has no usable entry");
+
+  // deepest directory holding every entry, headers outside of it are not covered by the database
+  fs::path projectRoot = entriesByDirectory.begin()->first;
+  for (const auto &[directory, directoryEntries] : entriesByDirectory) {
+    fs::path directoryPath(directory);
+    auto [rootEnd, directoryEnd] =
+        std::mismatch(projectRoot.begin(), projectRoot.end(), directoryPath.begin(), directoryPath.end());
+    fs::path commonRoot;
+    for (auto it = projectRoot.begin(); it != rootEnd; ++it) commonRoot /= *it;
+    projectRoot = commonRoot;
+  }
+
+  for (auto &[directory, directoryEntries] : entriesByDirectory) {
+    std::stable_sort(directoryEntries.begin(), directoryEntries.end(),
+                     [](const DirectoryEntry &a, const DirectoryEntry &b) { return a.fileName < b.fileName; });
+    // every ancestor points to the first directory below it, a header outside any entry directory takes the entries
+    // sharing the longest path prefix with it
+    for (fs::path ancestor = fs::path(directory);; ancestor = ancestor.parent_path()) {
+      database.entriesByDirectory_.try_emplace(ancestor.string(), directoryEntries);
+      if (ancestor == projectRoot || ancestor == ancestor.parent_path()) break;
+    }
+  }
+  return database;
+}
+
+auto CompilationDatabase::getFlagSetIndex(const fs::path &headerPath) const -> std::optional<size_t> {
+  fs::path header = fs::absolute(headerPath).lexically_normal();
+  if (auto it = flagSetByFile_.find(header.string()); it != flagSetByFile_.end()) return it->second;
+
+  std::string stem = header.stem().string();
+  for (fs::path directory = header.parent_path();; directory = directory.parent_path()) {
+    auto it = entriesByDirectory_.find(directory.string());
+    if (it != entriesByDirectory_.end()) {
+      for (const auto &entry : it->second)
+        if (entry.stem == stem) return entry.flagSet;
+      return it->second.front().flagSet;
+    }
+    if (directory == directory.parent_path()) break;
+  }
+  return std::nullopt;
+}
+
+auto CompilationDatabase::addToDigest(std::string_view value) -> void {
+  // FNV-1a, the terminating zero keeps {"ab", "c"} apart from {"a", "bc"}
+  for (char c : value) {
+    digest_ ^= static_cast<unsigned char>(c);
+    digest_ *= 0x100000001b3ULL;
+  }
+  digest_ *= 0x100000001b3ULL;
+}
+
+auto CompilationDatabase::getDigest() const -> uint64_t { return digest_; }
+
+auto CompilationDatabase::getFlagSets() const -> const std::vector<std::vector<std::string>> & { return flagSets_; }
+
+auto CompilationDatabase::getEntriesCount() const -> size_t { return entriesCount_; }
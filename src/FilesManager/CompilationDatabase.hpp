@@ -0,0 +1,125 @@
+#ifndef COMPILATIONDATABASE_HPP_
+#define COMPILATIONDATABASE_HPP_
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Flags of a compile_commands.json reduced to what the parser needs (include paths, macros, language standard,
+ * forced includes, target and sysroot) and deduplicated, so headers compiled alike share a flag set
+ *
+ * A header takes the flag set of its own entry when the database lists it, else the one of the translation unit with
+ * the same stem in the nearest directory holding entries (foo.hpp takes foo.cpp), else the first entry of that
+ * directory. Headers outside the deepest directory holding every entry are not covered
+ *
+ * @class CompilationDatabase
+ */
+class CompilationDatabase {
+ public:
+  /**
+   * @brief Loads a compilation database
+   *
+   * @arg path compile_commands.json, or a directory holding one
+   *
+   * @return std::expected<CompilationDatabase, std::string>
+   */
+  static auto load(const fs::path &path) -> std::expected<CompilationDatabase, std::string>;
+
+  /**
+   * @brief Gets the flag set of a header, safe to call from several threads
+   *
+   * @arg headerPath
+   *
+   * @return std::optional<size_t> index in getFlagSets(), empty when no entry is close enough
+   */
+  auto getFlagSetIndex(const fs::path &headerPath) const -> std::optional<size_t>;
+
+  /**
+   * @brief Gets the distinct flag sets of the database
+   *
+   * @return const std::vector<std::vector<std::string>> &
+   */
+  auto getFlagSets() const -> const std::vector<std::vector<std::string>> &;
+
+  /**
+   * @brief Gets the number of entries read from the database
+   *
+   * @return size_t
+   */
+  auto getEntriesCount() const -> size_t;
+
+  /**
+   * @brief Gets a digest of the flags every entry is parsed with, it moves whenever a header may parse differently
+   *
+   * @return uint64_t
+   */
+  auto getDigest() const -> uint64_t;
+
+  /**
+   * @brief Splits a shell command line into arguments, honouring quotes and backslash escapes
+   *
+   * @arg command
+   *
+   * @return std::vector<std::string>
+   */
+  static auto splitCommand(const std::string &command) -> std::vector<std::string>;
+
+  /**
+   * @brief Keeps the flags of a compiler invocation that matter to the parser, relative paths are resolved against
+   * the directory of the entry
+   *
+   * @arg arguments full invocation, compiler first
+   * @arg directory working directory of the entry
+   *
+   * @return std::vector<std::string>
+   */
+  static auto extractFlags(const std::vector<std::string> &arguments, const fs::path &directory)
+      -> std::vector<std::string>;
+
+ private:
+  /**
+   * @brief Entry of a directory, kept sorted by file name
+   *
+   * @struct DirectoryEntry
+   */
+  struct DirectoryEntry {
+    std::string fileName;
+    std::string stem;
+    size_t flagSet;
+  };
+
+  /**
+   * @brief Gets the index of a flag set, adding it when it is new
+   *
+   * @arg flags
+   *
+   * @return size_t
+   */
+  auto internFlagSet(std::vector<std::string> flags) -> size_t;
+
+  /**
+   * @brief Folds a value into the digest
+   *
+   * @arg value
+   *
+   * @return void
+   */
+  auto addToDigest(std::string_view value) -> void;
+
+  size_t entriesCount_ = 0;
+  uint64_t digest_ = 0xcbf29ce484222325ULL;
+  std::vector<std::vector<std::string>> flagSets_;
+  std::unordered_map<std::string, size_t> flagSetIndexes_;
+  std::unordered_map<std::string, size_t> flagSetByFile_;
+  std::unordered_map<std::string, std::vector<DirectoryEntry>> entriesByDirectory_;
+};
+
+#endif /* !COMPILATIONDATABASE_HPP_ */
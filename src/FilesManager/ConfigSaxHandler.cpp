@@ -0,0 +1,153 @@
+#include "ConfigSaxHandler.hpp"
+
+/**
+ * @brief Calls assign on the field of an object stored under the given key, nothing for an unknown key
+ *
+ * @arg obj
+ * @arg key
+ * @arg assign
+ *
+ * @return void
+ */
+template <typename Assign>
+static auto assignField(Object &obj, std::string_view key, Assign &&assign) -> void {
+  Object::visitFields(obj, [&key, &assign](std::string_view fieldKey, auto &field) {
+    if (fieldKey == key) assign(field);
+  });
+}
+
+ConfigSaxHandler::ConfigSaxHandler(json::json &settings, std::vector<Object> *objects)
+    : settings_(settings), objects_(objects) {}
+
+auto ConfigSaxHandler::addSetting(json::json &&value) -> json::json * {
+  if (stack_.empty() || stack_.back().kind != FrameKind::Settings) return nullptr;
+  json::json *dom = stack_.back().dom;
+  if (dom->is_array()) {
+    dom->push_back(std::move(value));
+    return &dom->back();
+  }
+  (*dom)[key_] = std::move(value);
+  return &(*dom)[key_];
+}
+
+auto ConfigSaxHandler::null() -> bool {
+  addSetting(nullptr);
+  return true;
+}
+
+auto ConfigSaxHandler::boolean(bool val) -> bool {
+  addSetting(val);
+  return true;
+}
+
+auto ConfigSaxHandler::number_integer(number_integer_t val) -> bool {
+  addSetting(val);
+  return true;
+}
+
+auto ConfigSaxHandler::number_unsigned(number_unsigned_t val) -> bool {
+  if (stack_.empty() || stack_.back().kind != FrameKind::ObjectEntry) {
+    addSetting(val);
+    return true;
+  }
+  assignField(objects_->back(), key_, [val](auto &field) {
+    if constexpr (std::is_same_v<std::remove_cvref_t<decltype(field)>, uint32_t>) field = static_cast<uint32_t>(val);
+  });
+  return true;
+}
+
+auto ConfigSaxHandler::number_float(number_float_t val, const string_t & /*s*/) -> bool {
+  addSetting(val);
+  return true;
+}
+
+auto ConfigSaxHandler::string(string_t &val) -> bool {
+  if (stack_.empty()) return true;
+  if (stack_.back().kind == FrameKind::Arguments) {
+    arguments_.push_back(StringPool::global().intern(val));
+    return true;
+  }
+  if (stack_.back().kind != FrameKind::ObjectEntry) {
+    addSetting(std::move(val));
+    return true;
+  }
+  Object &obj = objects_->back();
+  assignField(obj, key_, [&obj, &val](auto &field) {
+    using Field = std::remove_cvref_t<decltype(field)>;
+    if constexpr (std::is_same_v<Field, std::string_view>)
+      field = StringPool::global().intern(val);
+    else if constexpr (std::is_same_v<Field, ObjectType>)
+      field = obj.getObjectTypeFromString(val);
+  });
+  return true;
+}
+
+auto ConfigSaxHandler::binary(binary_t & /*val*/) -> bool { return true; }
+
+auto ConfigSaxHandler::start_object(std::size_t /*elements*/) -> bool {
+  if (stack_.empty()) {
+    settings_ = json::json::object();
+    stack_.push_back({FrameKind::Settings, &settings_});
+    return true;
+  }
+  switch (stack_.back().kind) {
+    case FrameKind::Settings: stack_.push_back({FrameKind::Settings, addSetting(json::json::object())}); break;
+    case FrameKind::ObjectsArray:
+      if (objects_) {
+        objects_->emplace_back();
+        stack_.push_back({FrameKind::ObjectEntry, nullptr});
+      } else {
+        stack_.push_back({FrameKind::Skip, nullptr});
+      }
+      break;
+    default: stack_.push_back({FrameKind::Skip, nullptr}); break;
+  }
+  return true;
+}
+
+auto ConfigSaxHandler::key(string_t &val) -> bool {
+  key_ = std::move(val);
+  return true;
+}
+
+auto ConfigSaxHandler::end_object() -> bool {
+  if (!stack_.empty()) stack_.pop_back();
+  return true;
+}
+
+auto ConfigSaxHandler::start_array(std::size_t /*elements*/) -> bool {
+  if (stack_.empty()) {
+    stack_.push_back({FrameKind::Skip, nullptr});
+    return true;
+  }
+  Frame &top = stack_.back();
+  if (top.kind == FrameKind::Settings && stack_.size() == 1 && key_ == "objects") {
+    if (objects_) objects_->clear();
+    stack_.push_back({FrameKind::ObjectsArray, nullptr});
+  } else if (top.kind == FrameKind::Settings) {
+    stack_.push_back({FrameKind::Settings, addSetting(json::json::array())});
+  } else if (top.kind == FrameKind::ObjectEntry) {
+    // only a list field keeps what is collected here
+    arguments_.clear();
+    stack_.push_back({FrameKind::Arguments, nullptr});
+  } else {
+    stack_.push_back({FrameKind::Skip, nullptr});
+  }
+  return true;
+}
+
+auto ConfigSaxHandler::end_array() -> bool {
+  if (!stack_.empty() && stack_.back().kind == FrameKind::Arguments)
+    assignField(objects_->back(), key_, [this](auto &field) {
+      using Field = std::remove_cvref_t<decltype(field)>;
+      if constexpr (std::is_same_v<Field, const std::vector<std::string_view> *>)
+        field = StringPool::global().internList(arguments_);
+    });
+  if (!stack_.empty()) stack_.pop_back();
+  return true;
+}
+
+auto ConfigSaxHandler::parse_error(std::size_t /*position*/, const std::string & /*lastToken*/,
+                                   const json::detail::exception & /*ex*/) -> bool {
+  return false;
+}
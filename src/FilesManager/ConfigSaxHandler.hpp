@@ -0,0 +1,83 @@
+#ifndef CONFIGSAXHANDLER_HPP_
+#define CONFIGSAXHANDLER_HPP_
+
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "ObjectsManager/Object.hpp"
+
+namespace json = nlohmann;
+
+/**
+ * @brief SAX handler reading a config file, settings are gathered in a small JSON document while the entries of the
+ * "objects" array are written straight into Object fields, or skipped without being materialised
+ *
+ * @class ConfigSaxHandler
+ */
+class ConfigSaxHandler : public json::json_sax<json::json> {
+ public:
+  /**
+   * @brief Constructs a ConfigSaxHandler
+   *
+   * @arg settings receives every top-level key except "objects"
+   * @arg objects receives the parsed objects, nullptr skips the objects array
+   */
+  ConfigSaxHandler(json::json &settings, std::vector<Object> *objects);
+
+  /**
+   * @brief Destructor for ConfigSaxHandler
+   */
+  ~ConfigSaxHandler() override = default;
+
+  auto null() -> bool override;
+  auto boolean(bool val) -> bool override;
+  auto number_integer(number_integer_t val) -> bool override;
+  auto number_unsigned(number_unsigned_t val) -> bool override;
+  auto number_float(number_float_t val, const string_t &s) -> bool override;
+  auto string(string_t &val) -> bool override;
+  auto binary(binary_t &val) -> bool override;
+  auto start_object(std::size_t elements) -> bool override;
+  auto key(string_t &val) -> bool override;
+  auto end_object() -> bool override;
+  auto start_array(std::size_t elements) -> bool override;
+  auto end_array() -> bool override;
+  auto parse_error(std::size_t position, const std::string &lastToken, const json::detail::exception &ex)
+      -> bool override;
+
+ private:
+  /**
+   * @brief What the innermost open container is being read into
+   *
+   * @enum FrameKind
+   */
+  enum class FrameKind { Settings, ObjectsArray, ObjectEntry, Arguments, Skip };
+
+  /**
+   * @brief Open container while walking the document
+   *
+   * @struct Frame
+   */
+  struct Frame {
+    FrameKind kind;
+    json::json *dom;
+  };
+
+  /**
+   * @brief Stores a settings value in the innermost settings container
+   *
+   * @arg value
+   *
+   * @return json::json * the stored value
+   */
+  auto addSetting(json::json &&value) -> json::json *;
+
+  json::json &settings_;
+  std::vector<Object> *objects_;
+  std::vector<Frame> stack_;
+  std::string key_;
+  // arguments of the current object, interned as one list once the array ends
+  std::vector<std::string_view> arguments_;
+};
+
+#endif /* !CONFIGSAXHANDLER_HPP_ */
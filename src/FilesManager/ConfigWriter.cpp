@@ -0,0 +1,157 @@
+#include "ConfigWriter.hpp"
+
+namespace {
+
+constexpr size_t StreamBufferSize = 1 << 20;
+constexpr size_t IndentWidth = 4;
+
+/**
+ * @brief Length of the valid UTF-8 sequence starting at pos, 0 if the bytes there do not form one
+ */
+auto validSequenceLength(std::string_view str, size_t pos) -> size_t {
+  auto byte = [&str](size_t i) { return static_cast<unsigned char>(str[i]); };
+  unsigned char lead = byte(pos);
+  size_t length = 0;
+  uint32_t codepoint = 0;
+  if (lead < 0x80) return 1;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+    codepoint = lead & 0x1F;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    codepoint = lead & 0x0F;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    codepoint = lead & 0x07;
+  } else {
+    return 0;
+  }
+  if (pos + length > str.size()) return 0;
+  for (size_t i = 1; i < length; ++i) {
+    if ((byte(pos + i) & 0xC0) != 0x80) return 0;
+    codepoint = (codepoint << 6) | (byte(pos + i) & 0x3F);
+  }
+  // overlong forms, surrogates and values past the last plane
+  if ((length == 3 && codepoint < 0x800) || (length == 4 && codepoint < 0x10000)) return 0;
+  if ((codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF) return 0;
+  return length;
+}
+
+}  // namespace
+
+ConfigWriter::ConfigWriter(fs::path configPath, bool compact)
+    : compact_(compact),
+      hasSettings_(false),
+      objectCount_(0),
+      buffer_(std::make_unique<char[]>(StreamBufferSize)),
+      file_(std::move(configPath)),
+      out_(file_.stream()) {}
+
+auto ConfigWriter::begin(const json::json &settings) -> std::expected<void, std::string> {
+  if (!settings.is_object()) return std::unexpected("Config settings must be a JSON object");
+
+  auto openResult = file_.open(buffer_.get(), StreamBufferSize);
+  if (!openResult) return openResult;
+
+  hasSettings_ = !settings.empty();
+  std::string text = settings.dump(compact_ ? -1 : static_cast<int>(IndentWidth), ' ', false,
+                                   json::json::error_handler_t::replace);
+  // reopen the dumped document: drop the closing brace and the line break before it
+  text.pop_back();
+  if (!compact_ && hasSettings_) text.pop_back();
+  out_ << text;
+
+  if (hasSettings_) out_ << ',';
+  newline(1);
+  writeString("objects");
+  out_ << (compact_ ? ":[" : ": [");
+  return {};
+}
+
+auto ConfigWriter::newline(size_t depth) -> void {
+  if (compact_) return;
+  out_ << '\n';
+  for (size_t i = 0; i < depth * IndentWidth; ++i) out_ << ' ';
+}
+
+auto ConfigWriter::writeKey(std::string_view key, bool first) -> void {
+  if (!first) out_ << ',';
+  newline(3);
+  writeString(key);
+  out_ << (compact_ ? ":" : ": ");
+}
+
+auto ConfigWriter::writeString(std::string_view value) -> void {
+  static constexpr char Hex[] = "0123456789abcdef";
+  out_ << '"';
+  size_t pos = 0;
+  while (pos < value.size()) {
+    unsigned char c = static_cast<unsigned char>(value[pos]);
+    switch (c) {
+      case '"': out_ << "\\\""; break;
+      case '\\': out_ << "\\\\"; break;
+      case '\b': out_ << "\\b"; break;
+      case '\f': out_ << "\\f"; break;
+      case '\n': out_ << "\\n"; break;
+      case '\r': out_ << "\\r"; break;
+      case '\t': out_ << "\\t"; break;
+      default:
+        if (c < 0x20) {
+          out_ << "\\u00" << Hex[c >> 4] << Hex[c & 0x0F];
+        } else if (size_t length = validSequenceLength(value, pos); length > 0) {
+          out_.write(value.data() + pos, static_cast<std::streamsize>(length));
+          pos += length;
+          continue;
+        } else {
+          // the reader rejects invalid UTF-8, so stray bytes (e.g. Latin-1 comments) are replaced
+          out_ << "\xEF\xBF\xBD";
+        }
+    }
+    ++pos;
+  }
+  out_ << '"';
+}
+
+auto ConfigWriter::writeObject(const Object &obj) -> ObjectSpan {
+  if (objectCount_++ > 0) out_ << ',';
+  newline(2);
+  uint64_t start = static_cast<uint64_t>(out_.tellp());
+  out_ << '{';
+
+  // visited in the key order of a dumped JSON object, so both writers produce the same file
+  bool first = true;
+  Object::visitFields(obj, [this, &obj, &first](std::string_view key, const auto &field) {
+    writeKey(key, first);
+    first = false;
+    using Field = std::remove_cvref_t<decltype(field)>;
+    if constexpr (std::is_same_v<Field, std::string_view>) {
+      writeString(field);
+    } else if constexpr (std::is_same_v<Field, uint32_t>) {
+      out_ << field;
+    } else if constexpr (std::is_same_v<Field, ObjectType>) {
+      writeString(obj.getObjectTypeAsString());
+    } else {
+      out_ << '[';
+      for (size_t i = 0; i < field->size(); ++i) {
+        if (i > 0) out_ << ',';
+        newline(4);
+        writeString((*field)[i]);
+      }
+      if (!field->empty()) newline(3);
+      out_ << ']';
+    }
+  });
+
+  newline(2);
+  out_ << '}';
+  return {start, static_cast<uint32_t>(static_cast<uint64_t>(out_.tellp()) - start)};
+}
+
+auto ConfigWriter::commit() -> std::expected<void, std::string> {
+  if (!out_.is_open()) return std::unexpected("Config file was not opened for writing");
+  if (objectCount_ > 0) newline(1);
+  out_ << ']';
+  newline(0);
+  out_ << '}';
+  return file_.commit();
+}
@@ -0,0 +1,107 @@
+#ifndef CONFIGWRITER_HPP_
+#define CONFIGWRITER_HPP_
+
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+
+#include "AtomicFile.hpp"
+#include "ObjectStore.hpp"
+#include "ObjectsManager/Object.hpp"
+
+namespace fs = std::filesystem;
+namespace json = nlohmann;
+
+/**
+ * @brief Streams a config file to disk, the settings are dumped first then each object is serialized straight to a
+ * buffered file stream, so no document holding every object is ever built
+ *
+ * The file goes through an AtomicFile renamed over the target by commit(), a failed or interrupted save leaves the
+ * previous config untouched
+ *
+ * @class ConfigWriter
+ */
+class ConfigWriter {
+ public:
+  /**
+   * @brief Constructs a ConfigWriter
+   *
+   * @arg configPath path of the config file to replace
+   * @arg compact if true, the file is written without indentation or line breaks
+   */
+  ConfigWriter(fs::path configPath, bool compact);
+
+  /**
+   * @brief Destructor for ConfigWriter, drops the temporary file if commit() was never reached
+   */
+  ~ConfigWriter() = default;
+
+  ConfigWriter(const ConfigWriter &) = delete;
+  auto operator=(const ConfigWriter &) -> ConfigWriter & = delete;
+
+  /**
+   * @brief Opens the temporary file and writes the settings, every top-level key except "objects"
+   *
+   * @arg settings
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto begin(const json::json &settings) -> std::expected<void, std::string>;
+
+  /**
+   * @brief Appends an object to the "objects" array
+   *
+   * @arg obj
+   *
+   * @return ObjectSpan where the JSON object of obj lies in the config file
+   */
+  auto writeObject(const Object &obj) -> ObjectSpan;
+
+  /**
+   * @brief Closes the document, flushes the stream and renames the temporary file over the config file
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto commit() -> std::expected<void, std::string>;
+
+ private:
+  /**
+   * @brief Writes a line break followed by the indentation of the given depth, nothing in compact mode
+   *
+   * @arg depth
+   *
+   * @return void
+   */
+  auto newline(size_t depth) -> void;
+
+  /**
+   * @brief Writes an object key and the separator before its value
+   *
+   * @arg key
+   * @arg first if false, the previous member is closed with a comma first
+   *
+   * @return void
+   */
+  auto writeKey(std::string_view key, bool first) -> void;
+
+  /**
+   * @brief Writes a quoted JSON string, invalid UTF-8 sequences are replaced by U+FFFD
+   *
+   * @arg value
+   *
+   * @return void
+   */
+  auto writeString(std::string_view value) -> void;
+
+  bool compact_;
+  bool hasSettings_;
+  size_t objectCount_;
+  std::unique_ptr<char[]> buffer_;
+  AtomicFile file_;
+  std::ofstream &out_;
+};
+
+#endif /* !CONFIGWRITER_HPP_ */
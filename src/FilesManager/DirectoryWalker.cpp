@@ -0,0 +1,146 @@
+#include "DirectoryWalker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <optional>
+#include <thread>
+#include <unordered_set>
+
+#include "Profiler/AllocationTracker.hpp"
+
+DirectoryWalker::DirectoryWalker(PathFilter filter, std::vector<std::string> headerExtensions, bool recursive,
+                                 size_t jobs)
+    : filter_(std::move(filter)),
+      headerExtensions_(std::move(headerExtensions)),
+      recursive_(recursive),
+      jobs_(jobs == 0 ? std::max<size_t>(1, std::thread::hardware_concurrency()) : jobs) {}
+
+auto DirectoryWalker::hasHeaderExtension(const fs::path &filePath) const -> bool {
+  return std::any_of(headerExtensions_.begin(), headerExtensions_.end(),
+                     [&](const std::string &ext) { return filePath.extension() == ext; });
+}
+
+auto DirectoryWalker::walk(const std::vector<fs::path> &roots, const FileCallback &onFile) -> std::vector<fs::path> {
+  std::vector<WorkerQueue> queues(jobs_);
+  std::vector<std::vector<fs::path>> found(jobs_);
+  // directories queued or being listed, the walk is over when it drops to zero
+  std::atomic<size_t> pending = 0;
+  // directories waiting in a queue, idle workers sleep until one is pushed or the walk is over
+  std::atomic<size_t> queued = 0;
+  std::mutex idleMutex;
+  std::condition_variable idleCondition;
+  auto wakeIdle = [&](bool all) {
+    {
+      // taking the mutex orders the notification after a waiter checked its condition
+      std::lock_guard lock(idleMutex);
+    }
+    if (all)
+      idleCondition.notify_all();
+    else
+      idleCondition.notify_one();
+  };
+
+  // overlapping roots can reach a file twice, the callback only hears about it once
+  std::mutex seenMutex;
+  std::unordered_set<std::string> seen;
+  bool overlapPossible = roots.size() > 1;
+
+  auto report = [&](size_t worker, const fs::path &file) {
+    if (overlapPossible) {
+      std::lock_guard lock(seenMutex);
+      if (!seen.insert(fs::absolute(file).lexically_normal().string()).second) return;
+    }
+    found[worker].push_back(file);
+    if (onFile) onFile(file);
+  };
+
+  size_t nextQueue = 0;
+  for (const auto &root : roots) {
+    std::error_code ec;
+    fs::file_status status = fs::status(root, ec);
+    if (ec) continue;
+    if (fs::is_regular_file(status) && hasHeaderExtension(root)) {
+      report(0, root);
+    } else if (fs::is_directory(status)) {
+      ++pending;
+      ++queued;
+      queues[nextQueue++ % jobs_].tasks.push_back({root, std::string()});
+    }
+  }
+
+  auto popTask = [&](size_t worker) -> std::optional<Task> {
+    {
+      std::lock_guard lock(queues[worker].mutex);
+      if (!queues[worker].tasks.empty()) {
+        Task task = std::move(queues[worker].tasks.back());
+        queues[worker].tasks.pop_back();
+        --queued;
+        return task;
+      }
+    }
+    for (size_t offset = 1; offset < jobs_; ++offset) {
+      WorkerQueue &victim = queues[(worker + offset) % jobs_];
+      std::lock_guard lock(victim.mutex);
+      if (victim.tasks.empty()) continue;
+      Task task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      --queued;
+      return task;
+    }
+    return std::nullopt;
+  };
+
+  auto listDirectory = [&](size_t worker, const Task &task) {
+    std::error_code ec;
+    fs::directory_iterator it(task.directory, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+      const fs::directory_entry &entry = *it;
+      std::string name = entry.path().filename().string();
+      std::string relativePath = task.relativePath.empty() ? name : task.relativePath + "/" + name;
+
+      std::error_code typeEc;
+      // the type comes from the directory listing, a stat only happens for symlinks or unknown types
+      if (entry.is_directory(typeEc)) {
+        if (!recursive_ || entry.is_symlink(typeEc) || filter_.isExcluded(relativePath, true)) continue;
+        ++pending;
+        ++queued;
+        {
+          std::lock_guard lock(queues[worker].mutex);
+          queues[worker].tasks.push_back({entry.path(), std::move(relativePath)});
+        }
+        wakeIdle(false);
+      } else if (entry.is_regular_file(typeEc) && hasHeaderExtension(entry.path()) &&
+                 !filter_.isExcluded(relativePath, false)) {
+        report(worker, entry.path());
+      }
+    }
+  };
+
+  auto worker = [&](size_t index) {
+    AllocationScope allocationScope(Subsystem::Walk);
+    while (true) {
+      auto task = popTask(index);
+      if (!task) {
+        std::unique_lock lock(idleMutex);
+        idleCondition.wait(lock, [&]() { return pending.load() == 0 || queued.load() > 0; });
+        if (pending.load() == 0) return;
+        continue;
+      }
+      listDirectory(index, task.value());
+      if (--pending == 0) wakeIdle(true);
+    }
+  };
+  {
+    std::vector<std::jthread> workers;
+    for (size_t i = 1; i < jobs_; ++i) workers.emplace_back(worker, i);
+    worker(0);
+  }
+
+  std::vector<fs::path> files;
+  for (auto &workerFiles : found) files.insert(files.end(), workerFiles.begin(), workerFiles.end());
+  // thread scheduling changes the discovery order, sorting keeps runs reproducible
+  std::sort(files.begin(), files.end());
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  return files;
+}
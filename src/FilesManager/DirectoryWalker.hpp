@@ -0,0 +1,87 @@
+#ifndef DIRECTORYWALKER_HPP_
+#define DIRECTORYWALKER_HPP_
+
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "PathFilter.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Collects header files under a set of roots with a pool of work-stealing threads
+ *
+ * Every directory is a task: a worker lists it, reports matching files and queues its subdirectories on its own
+ * deque, idle workers steal from the other ends. Excluded subtrees are never queued, and entry types come from the
+ * cached directory entry instead of a stat per entry. Symlinked directories are not followed
+ *
+ * @class DirectoryWalker
+ */
+class DirectoryWalker {
+ public:
+  /**
+   * @brief Callback receiving each header file as soon as it is found, called from the walker threads
+   */
+  using FileCallback = std::function<void(const fs::path &)>;
+
+  /**
+   * @brief Constructs a DirectoryWalker
+   *
+   * @arg filter exclude patterns, matched against paths relative to each root
+   * @arg headerExtensions extensions of the files to collect
+   * @arg recursive if false, only the entries directly under the roots are listed
+   * @arg jobs number of threads, 0 uses every available core
+   */
+  DirectoryWalker(PathFilter filter, std::vector<std::string> headerExtensions, bool recursive, size_t jobs = 0);
+
+  /**
+   * @brief Walks the roots, a root that is itself a header file is collected as is
+   *
+   * @arg roots
+   * @arg onFile optional callback streaming the files while the walk goes on
+   *
+   * @return std::vector<fs::path> collected files, sorted and without duplicates
+   */
+  auto walk(const std::vector<fs::path> &roots, const FileCallback &onFile = {}) -> std::vector<fs::path>;
+
+ private:
+  /**
+   * @brief Directory waiting to be listed
+   *
+   * @struct Task
+   */
+  struct Task {
+    fs::path directory;
+    std::string relativePath;
+  };
+
+  /**
+   * @brief Task deque of one worker, the owner works at the back and thieves take from the front
+   *
+   * @struct WorkerQueue
+   */
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /**
+   * @brief Checks if a file has a header file extension
+   *
+   * @arg filePath
+   *
+   * @return bool
+   */
+  auto hasHeaderExtension(const fs::path &filePath) const -> bool;
+
+  PathFilter filter_;
+  std::vector<std::string> headerExtensions_;
+  bool recursive_;
+  size_t jobs_;
+};
+
+#endif /* !DIRECTORYWALKER_HPP_ */
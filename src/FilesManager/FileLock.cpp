@@ -0,0 +1,43 @@
+#include "FileLock.hpp"
+
+#include <cerrno>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+FileLock::FileLock(FileLock &&other) noexcept { *this = std::move(other); }
+
+auto FileLock::operator=(FileLock &&other) noexcept -> FileLock & {
+  if (this == &other) return *this;
+  release();
+  fd_ = other.fd_;
+  other.fd_ = -1;
+  return *this;
+}
+
+FileLock::~FileLock() { release(); }
+
+auto FileLock::acquire(const fs::path &lockPath, bool exclusive) -> std::expected<FileLock, std::string> {
+  FileLock lock;
+#if !defined(_WIN32)
+  lock.fd_ = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+  if (lock.fd_ < 0) return std::unexpected("Failed to open lock file " + lockPath.string());
+  int result;
+  do {
+    result = ::flock(lock.fd_, exclusive ? LOCK_EX : LOCK_SH);
+  } while (result != 0 && errno == EINTR);
+  if (result != 0) return std::unexpected("Failed to lock " + lockPath.string());
+#endif
+  return lock;
+}
+
+auto FileLock::release() -> void {
+#if !defined(_WIN32)
+  // closing the file drops the lock
+  if (fd_ >= 0) ::close(fd_);
+#endif
+  fd_ = -1;
+}
@@ -0,0 +1,68 @@
+#ifndef FILELOCK_HPP_
+#define FILELOCK_HPP_
+
+#include <expected>
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Advisory lock held on a file while the object lives, used to serialize the runs updating the same store
+ *
+ * @class FileLock
+ */
+class FileLock {
+ public:
+  /**
+   * @brief Constructs an empty FileLock holding nothing
+   */
+  FileLock() = default;
+
+  FileLock(const FileLock &) = delete;
+  auto operator=(const FileLock &) -> FileLock & = delete;
+
+  /**
+   * @brief Move constructor, the lock is transferred
+   *
+   * @arg other
+   */
+  FileLock(FileLock &&other) noexcept;
+
+  /**
+   * @brief Move assignment, the current lock is released first
+   *
+   * @arg other
+   *
+   * @return FileLock &
+   */
+  auto operator=(FileLock &&other) noexcept -> FileLock &;
+
+  /**
+   * @brief Destructor for FileLock, releases the lock
+   */
+  ~FileLock();
+
+  /**
+   * @brief Waits for the lock on a file, created if missing. Platforms without advisory locks get a lock holding
+   * nothing
+   *
+   * @arg lockPath
+   * @arg exclusive if false, the lock is shared with the other readers
+   *
+   * @return std::expected<FileLock, std::string>
+   */
+  static auto acquire(const fs::path &lockPath, bool exclusive) -> std::expected<FileLock, std::string>;
+
+ private:
+  /**
+   * @brief Releases the lock and closes the file
+   *
+   * @return void
+   */
+  auto release() -> void;
+
+  int fd_ = -1;
+};
+
+#endif /* !FILELOCK_HPP_ */
@@ -1,68 +1,409 @@
 #include "FilesManager.hpp"
 
-FilesManager::FilesManager(fs::path configPath, bool noSave, fs::path modPath, std::vector<std::string> paths,
-                           std::vector<std::string> defaultHeaderExtensions,
-                           std::vector<std::string> defaultExcludeDirs, std::vector<std::string> wordsBlacklist,
-                           std::vector<std::string> typesBlacklist, bool recursive)
-    : configPath_(configPath),
-      noSave_(noSave),
-      modPath_(modPath),
-      recursive_(recursive),
-      headerExtensions_(defaultHeaderExtensions),
-      excludeDirs_(defaultExcludeDirs),
-      wordsBlacklist_(wordsBlacklist),
-      typesBlacklist_(typesBlacklist),
+#include <random>
+
+#include "MappedFile.hpp"
+#include "Profiler/AllocationTracker.hpp"
+#include "Profiler/Profiler.hpp"
+
+/**
+ * @brief gets the StoreFormat from its string representation
+ *
+ * @arg formatStr
+ *
+ * @return std::optional<StoreFormat>
+ */
+static auto getStoreFormatFromString(const std::string &formatStr) -> std::optional<StoreFormat> {
+  for (const auto &[format, name] : StoreFormatStringMap)
+    if (name == formatStr) return format;
+  return std::nullopt;
+}
+
+FilesManager::FilesManager(FilesManagerOptions options)
+    : recursive_(options.recursive),
+      noSave_(options.noSave),
+      loadObjects_(options.loadObjects),
+      fullScan_(options.fullScan),
+      declarationsOnly_(options.declarationsOnly),
+      compactConfig_(options.compactConfig),
+      sourcesFromConfig_(false),
+      storeFormatForced_(false),
+      storeFormat_(StoreFormat::Json),
+      configPath_(std::move(options.configPath)),
+      modPath_(std::move(options.modPath)),
+      excludeDirs_(std::move(options.excludeDirs)),
+      headerExtensions_(std::move(options.headerExtensions)),
+      wordsBlacklist_(std::move(options.wordsBlacklist)),
+      typesBlacklist_(std::move(options.typesBlacklist)),
+      compileCommands_(std::move(options.compileCommands)),
+      savedCompileCommandsDigest_(0),
+      savedSymbolIndexId_(0),
+      savedSettingsDigest_(0),
+      savedStoreFormat_(StoreFormat::Json),
+      savedObjectsLoaded_(options.loadObjects),
       objects_({}) {
-  for (const auto &pathStr : paths) sourcePaths_.push_back(fs::path(pathStr));
+  for (const auto &pathStr : options.paths) sourcePaths_.push_back(fs::path(pathStr));
+  for (const auto &include : options.pchIncludes)
+    if (!include.empty()) pchIncludes_.push_back(include);
+  if (!options.storeFormat.empty()) {
+    auto format = getStoreFormatFromString(options.storeFormat);
+    if (format) {
+      storeFormat_ = format.value();
+      storeFormatForced_ = true;
+    } else {
+      spdlog::warn("Unknown object store format '{}', keeping the configured one", options.storeFormat);
+    }
+  }
+}
+
+auto FilesManager::init(const DirectoryWalker::FileCallback &onFileFound) -> std::expected<void, std::string> {
+  auto settingsResult = initSettings();
+  if (!settingsResult) return settingsResult;
+  return initSources(onFileFound);
 }
 
-auto FilesManager::init() -> std::expected<void, std::string> {
+auto FilesManager::initSettings() -> std::expected<void, std::string> {
+  sourcesFromConfig_ = loadSettings();
+  // exclude patterns are compiled once, for the walk and for the paths checked after it
+  pathFilter_ = PathFilter(excludeDirs_);
+  loadCompilationDatabase();
+  // saved objects went through the module, blacklists and profile of the last save
+  if (!savedFingerprints_.empty() && getSettingsDigest() != savedSettingsDigest_) {
+    spdlog::info("Parse settings changed since the last save, parsing every header again");
+    savedFingerprints_.clear();
+  }
+  indexSavedObjects();
+  return {};
+}
+
+auto FilesManager::loadCompilationDatabase() -> void {
+  if (compileCommands_.empty()) return;
+  auto databaseResult = CompilationDatabase::load(compileCommands_);
+  if (!databaseResult) {
+    spdlog::warn("Failed to load compilation database {}, parsing headers with the default flags: {}",
+                 compileCommands_.string(), databaseResult.error());
+    // objects saved with the flags of the database would not parse the same way
+    if (!savedFingerprints_.empty() && savedCompileCommandsDigest_ != 0) savedFingerprints_.clear();
+    return;
+  }
+  compilationDatabase_ = std::move(databaseResult.value());
+  // unchanged headers keep their saved objects only if they would parse with the same flags
+  if (!savedFingerprints_.empty() && compilationDatabase_->getDigest() != savedCompileCommandsDigest_) {
+    spdlog::info("Compilation database changed since the last save, parsing every header again");
+    savedFingerprints_.clear();
+  }
+}
+
+auto FilesManager::getSettingsDigest() const -> uint64_t {
+  uint64_t digest = 0xcbf29ce484222325ULL;
+  // every field ends with a separator so that moving a character from one to the next changes the digest
+  auto hashField = [&digest](std::string_view field) {
+    for (unsigned char c : field) {
+      digest ^= c;
+      digest *= 0x100000001b3ULL;
+    }
+    digest ^= 0xff;
+    digest *= 0x100000001b3ULL;
+  };
+  hashField(modPath_.string());
+  for (const auto &word : wordsBlacklist_) hashField(word);
+  hashField("");
+  for (const auto &type : typesBlacklist_) hashField(type);
+  hashField("");
+  hashField(declarationsOnly_ ? "declarations" : "full");
+  return digest;
+}
+
+auto FilesManager::initSources(const DirectoryWalker::FileCallback &onFileFound) -> std::expected<void, std::string> {
+  if (sourcesFromConfig_) {
+    // files listed by the config are known at once, they are handed over without a walk
+    if (onFileFound)
+      for (const auto &path : sourcePaths_) onFileFound(path);
+  } else {
+    if (sourcePaths_.empty()) {
+      spdlog::warn("No source paths associated, using current directory");
+      sourcePaths_.push_back(fs::current_path());
+    }
+    sourceRoots_ = sourcePaths_;
+    auto collectResult = collectPathFiles(sourcePaths_, onFileFound);
+    if (!collectResult) return std::unexpected(collectResult.error());
+    sourcePaths_ = collectResult.value();
+    if (sourcePaths_.empty())
+      return std::unexpected("No source files found in the provided paths. Please check your paths and try again.");
+    if (configPath_.empty()) configPath_ = "toxiconf.json";
+  }
+  refreshFingerprints();
+  return {};
+}
+
+auto FilesManager::loadSettings() -> bool {
   bool tryConfig = false;
   if (!configPath_.empty()) {
     tryConfig = true;
     auto loadResult = loadConfig();
-    if (loadResult) return {};
+    if (loadResult) return true;
     spdlog::warn("Failed to load config: {}", loadResult.error());
     spdlog::info("Using provided parameters and defaults");
     configPath_ = "toxiconf.json";
     loadResult = loadConfig();
-    if (loadResult) return {};
+    if (loadResult) return true;
     spdlog::warn("Failed to load default config: {}", loadResult.error());
   }
   if (sourcePaths_.empty() && !tryConfig) {
     spdlog::warn("No source paths provided, trying to load from default config");
     configPath_ = "toxiconf.json";
     auto loadResult = loadConfig();
-    if (loadResult) return {};
+    if (loadResult) return true;
     spdlog::warn("Failed to load default config: {}", loadResult.error());
   }
-  if (sourcePaths_.empty()) {
-    spdlog::warn("No source paths associated, using current directory");
-    sourcePaths_.push_back(fs::current_path());
-  }
-  auto collectResult = collectPathFiles(sourcePaths_);
-  if (!collectResult) return std::unexpected(collectResult.error());
-  sourcePaths_ = collectResult.value();
-  if (sourcePaths_.empty())
-    return std::unexpected("No source files found in the provided paths. Please check your paths and try again.");
-  if (configPath_.empty()) configPath_ = "toxiconf.json";
-  return {};
+  return false;
 }
 
 auto FilesManager::getModulePath() const -> fs::path { return modPath_; }
 
-auto FilesManager::getSourcePaths() const -> std::vector<fs::path> { return sourcePaths_; }
+auto FilesManager::getSourcePaths() const -> const std::vector<fs::path> & { return sourcePaths_; }
 
-auto FilesManager::getSavedObjects() -> std::vector<Object> { return objects_; }
+auto FilesManager::getSourceRoots() const -> const std::vector<fs::path> & { return sourceRoots_; }
+
+auto FilesManager::getSavedObjects() const -> const std::vector<Object> & { return objects_; }
+
+auto FilesManager::getUnchangedFilesObjects() const -> std::unordered_map<std::string, std::vector<Object>> {
+  std::unordered_map<std::string, std::vector<Object>> unchangedObjects;
+  if (fullScan_) return unchangedObjects;
+  for (const auto &path : sourcePaths_) {
+    if (!isFileUnchanged(path.string())) continue;
+    auto &fileObjects = unchangedObjects[path.string()];
+    auto indexes = savedObjectsByFile_.find(path.string());
+    if (indexes == savedObjectsByFile_.end()) continue;
+    for (size_t index : indexes->second) fileObjects.push_back(objects_[index]);
+  }
+  return unchangedObjects;
+}
+
+auto FilesManager::isFileUnchanged(const std::string &filePath) const -> bool {
+  if (fullScan_) return false;
+  auto saved = savedFingerprints_.find(filePath);
+  auto current = fingerprints_.find(filePath);
+  if (saved == savedFingerprints_.end() || current == fingerprints_.end()) return false;
+  return saved->second.size == current->second.size && saved->second.hash == current->second.hash;
+}
+
+auto FilesManager::getStaleFiles() const -> std::vector<fs::path> {
+  std::vector<fs::path> staleFiles;
+  for (const auto &path : sourcePaths_)
+    if (!isFileUnchanged(path.string())) staleFiles.push_back(path);
+  return staleFiles;
+}
+
+auto FilesManager::loadSymbolIndex() -> const SymbolIndex & {
+  if (symbolIndex_) return symbolIndex_.value();
+  if (savedSymbolIndexId_ != 0) {
+    auto indexResult = SymbolIndex::load(getSymbolIndexPath(), savedSymbolIndexId_);
+    if (indexResult) {
+      symbolIndex_ = std::move(indexResult.value());
+      return symbolIndex_.value();
+    }
+    spdlog::warn("Failed to load symbol index {}: {}", getSymbolIndexPath().string(), indexResult.error());
+  }
+  if (!savedObjectsLoaded_) {
+    loadStoreObjects();
+    indexSavedObjects();
+  }
+  symbolIndex_ = SymbolIndex::build(objects_);
+  return symbolIndex_.value();
+}
+
+auto FilesManager::loadSavedFileObjects(const fs::path &filePath) -> std::vector<Object> {
+  // a shard is found by its header, the other stores are read at the locations kept by the index
+  if (!savedObjectsLoaded_ && savedStoreFormat_ != StoreFormat::Sharded) loadSymbolIndex();
+  if (savedObjectsLoaded_) return getSavedFileObjects(filePath);
+  auto fileObjects = readSavedFileObjects(filePath.string());
+  if (fileObjects) return std::move(fileObjects.value());
+  spdlog::warn("Failed to read the saved objects of {}, loading every saved object: {}", filePath.string(),
+               fileObjects.error());
+  loadStoreObjects();
+  indexSavedObjects();
+  return getSavedFileObjects(filePath);
+}
+
+/**
+ * @brief Reads the objects found at the given locations of a config file, the rest of the file is not parsed
+ *
+ * @arg configPath
+ * @arg spans locations given by ConfigWriter::writeObject
+ *
+ * @return std::expected<std::vector<Object>, std::string>
+ */
+static auto readConfigObjects(const fs::path &configPath, const std::vector<ObjectSpan> &spans)
+    -> std::expected<std::vector<Object>, std::string> {
+  auto mapResult = MappedFile::open(configPath);
+  if (!mapResult) return std::unexpected(mapResult.error());
+  std::string_view data = mapResult->view();
+  std::vector<Object> objects;
+  objects.reserve(spans.size());
+  for (const auto &span : spans) {
+    if (span.offset > data.size() || data.size() - span.offset < span.length)
+      return std::unexpected("Object location out of the config file");
+    auto first = data.begin() + static_cast<std::ptrdiff_t>(span.offset);
+    json::json objectJson = json::json::parse(first, first + span.length, nullptr, false);
+    if (!objectJson.is_object()) return std::unexpected("Object location does not match the config file");
+    objects.emplace_back(objectJson);
+  }
+  return objects;
+}
+
+auto FilesManager::readSavedFileObjects(const std::string &filePath)
+    -> std::expected<std::vector<Object>, std::string> {
+  std::expected<std::vector<Object>, std::string> fileObjects;
+  if (savedStoreFormat_ == StoreFormat::Sharded)
+    fileObjects = ShardedStore::loadHeader(savedStorePath_, filePath);
+  else if (savedStoreFormat_ == StoreFormat::Binary)
+    fileObjects = ObjectStore::loadSpans(savedStorePath_, symbolIndex_->getFileSpans(filePath));
+  else
+    fileObjects = readConfigObjects(savedStorePath_, symbolIndex_->getFileSpans(filePath));
+  if (!fileObjects) return fileObjects;
+  // a store replaced since the index was saved may still hold valid objects at the same places
+  for (const auto &obj : fileObjects.value())
+    if (obj.getObjectPathView() != filePath) return std::unexpected("Symbol index does not match the saved objects");
+  return fileObjects;
+}
+
+auto FilesManager::getUnchangedFileObjects(const fs::path &filePath) const -> std::optional<std::vector<Object>> {
+  if (fullScan_) return std::nullopt;
+  auto saved = savedFingerprints_.find(filePath.string());
+  if (saved == savedFingerprints_.end()) return std::nullopt;
+  auto current = computeFingerprint(filePath, &saved->second);
+  if (!current || current->size != saved->second.size || current->hash != saved->second.hash) return std::nullopt;
+  return getSavedFileObjects(filePath);
+}
+
+auto FilesManager::getSavedFileObjects(const fs::path &filePath) const -> std::vector<Object> {
+  std::vector<Object> fileObjects;
+  auto indexes = savedObjectsByFile_.find(filePath.string());
+  if (indexes != savedObjectsByFile_.end())
+    for (size_t index : indexes->second) fileObjects.push_back(objects_[index]);
+  return fileObjects;
+}
+
+auto FilesManager::getSavedObjectFiles() const -> std::vector<std::string> {
+  std::vector<std::pair<size_t, std::string>> firstIndexes;
+  firstIndexes.reserve(savedObjectsByFile_.size());
+  for (const auto &[filePath, indexes] : savedObjectsByFile_) firstIndexes.emplace_back(indexes.front(), filePath);
+  std::sort(firstIndexes.begin(), firstIndexes.end());
+  std::vector<std::string> files;
+  files.reserve(firstIndexes.size());
+  for (auto &[index, filePath] : firstIndexes) files.push_back(std::move(filePath));
+  return files;
+}
+
+auto FilesManager::indexSavedObjects() -> void {
+  savedObjectsByFile_.clear();
+  for (size_t i = 0; i < objects_.size(); ++i)
+    savedObjectsByFile_[std::string(objects_[i].getObjectPathView())].push_back(i);
+}
+
+auto FilesManager::dropSavedObjects() -> void {
+  objects_ = {};
+  savedObjectsByFile_ = {};
+  symbolIndex_.reset();
+  savedObjectsLoaded_ = true;
+}
+
+auto FilesManager::acceptsPath(const fs::path &path, bool isDirectory) const -> bool {
+  auto hasHeaderExtension = [this, &path]() {
+    return std::any_of(headerExtensions_.begin(), headerExtensions_.end(),
+                       [&path](const std::string &ext) { return path.extension() == ext; });
+  };
+  std::string relativePath = path.filename().string();
+  if (!sourceRoots_.empty()) {
+    // nested roots walk the same entries, the innermost one gives the shortest relative path
+    std::optional<fs::path> shortest;
+    for (const auto &root : sourceRoots_) {
+      fs::path relative = path.lexically_relative(root);
+      if (relative.empty() || *relative.begin() == "..") continue;
+      // a root is collected as it is, a directory root is always entered
+      if (relative == ".") return isDirectory || hasHeaderExtension();
+      if (!shortest || relative.native().size() < shortest->native().size()) shortest = std::move(relative);
+    }
+    if (!shortest) return false;
+    relativePath = shortest->generic_string();
+  }
+  if (pathFilter_.isExcluded(relativePath, isDirectory)) return false;
+  if (isDirectory) return recursive_;
+  return hasHeaderExtension();
+}
+
+auto FilesManager::updateSourceFile(const fs::path &filePath) -> bool {
+  if (std::find(sourcePaths_.begin(), sourcePaths_.end(), filePath) == sourcePaths_.end())
+    sourcePaths_.push_back(filePath);
+  auto current = fingerprints_.find(filePath.string());
+  auto fingerprint = computeFingerprint(filePath, current != fingerprints_.end() ? &current->second : nullptr);
+  if (!fingerprint) return false;
+  bool changed = current == fingerprints_.end() || current->second.size != fingerprint->size ||
+                 current->second.hash != fingerprint->hash;
+  fingerprints_[filePath.string()] = fingerprint.value();
+  return changed;
+}
+
+auto FilesManager::removeSourceFile(const fs::path &filePath) -> bool {
+  fingerprints_.erase(filePath.string());
+  return std::erase(sourcePaths_, filePath) > 0;
+}
+
+auto FilesManager::invalidateFingerprint(const fs::path &filePath) -> void { fingerprints_.erase(filePath.string()); }
 
 auto FilesManager::getWordsBlacklist() const -> std::vector<std::string> { return wordsBlacklist_; }
 
 auto FilesManager::getTypesBlacklist() const -> std::vector<std::string> { return typesBlacklist_; }
 
+auto FilesManager::getPchIncludes() const -> std::vector<std::string> { return pchIncludes_; }
+
+auto FilesManager::getCompilationDatabase() const -> const CompilationDatabase * {
+  return compilationDatabase_ ? &compilationDatabase_.value() : nullptr;
+}
+
+auto FilesManager::getConfigPath() const -> fs::path {
+  return configPath_.empty() ? fs::path("toxiconf.json") : configPath_;
+}
+
+auto FilesManager::getPrecompiledHeaderPath() const -> fs::path {
+  fs::path configPath = configPath_.empty() ? fs::path("toxiconf.json") : configPath_;
+  return configPath.parent_path() / (configPath.stem().string() + ".pch");
+}
+
+auto FilesManager::getObjectStorePath() const -> fs::path {
+  fs::path configPath = configPath_.empty() ? fs::path("toxiconf.json") : configPath_;
+  return configPath.parent_path() / (configPath.stem().string() + ".bin");
+}
+
+auto FilesManager::getShardStorePath() const -> fs::path {
+  fs::path configPath = configPath_.empty() ? fs::path("toxiconf.json") : configPath_;
+  return configPath.parent_path() / (configPath.stem().string() + ".d");
+}
+
+auto FilesManager::getSymbolIndexPath() const -> fs::path {
+  fs::path configPath = configPath_.empty() ? fs::path("toxiconf.json") : configPath_;
+  return configPath.parent_path() / (configPath.stem().string() + ".idx");
+}
+
 auto FilesManager::getLastSaveTime() const -> std::chrono::system_clock::time_point { return lastSaveTime_; }
 
-auto FilesManager::saveConfig(std::vector<Object> objects) -> std::expected<void, std::string> {
+/**
+ * @brief Makes the identifier of a save, written to the config and to the symbol index so a stale index is rejected
+ *
+ * @return uint64_t never 0, which stands for no index
+ */
+static auto makeSaveId() -> uint64_t {
+  std::random_device random;
+  uint64_t id = static_cast<uint64_t>(random()) << 32 | random();
+  id ^= static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+  return id != 0 ? id : 1;
+}
+
+auto FilesManager::saveConfig(const std::vector<Object> &objects) -> std::expected<void, std::string> {
   if (configPath_.empty()) return std::unexpected("Config path is empty");
+  ScopedTimer timer("store", "saveConfig");
+  AllocationScope allocationScope(Subsystem::Store);
 
   json::json configJson;
   configJson["exclude_dirs"] = excludeDirs_;
@@ -74,29 +415,84 @@ auto FilesManager::saveConfig(std::vector<Object> objects) -> std::expected<void
       std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 
   configJson["module_path"] = modPath_.string();
+  configJson["pch_includes"] = pchIncludes_;
+  // a database that failed to load stays configured, the next run tries it again
+  if (!compileCommands_.empty()) configJson["compile_commands"] = compileCommands_.string();
+  if (compilationDatabase_) configJson["compile_commands_digest"] = compilationDatabase_->getDigest();
+  configJson["settings_digest"] = getSettingsDigest();
 
   std::vector<std::string> sourcePathsStr;
   for (const auto &path : sourcePaths_) sourcePathsStr.push_back(path.string());
   configJson["source_paths"] = sourcePathsStr;
+  std::vector<std::string> sourceRootsStr;
+  for (const auto &root : sourceRoots_) sourceRootsStr.push_back(root.string());
+  configJson["source_roots"] = sourceRootsStr;
+
+  json::json fingerprintsJson = json::json::object();
+  for (const auto &[path, fingerprint] : fingerprints_)
+    fingerprintsJson[path] = {{"size", fingerprint.size}, {"mtime", fingerprint.mtime}, {"hash", fingerprint.hash}};
+  configJson["file_fingerprints"] = fingerprintsJson;
+
+  // the index is written last, once the objects are and their locations known, the id ties it to this save
+  uint64_t symbolIndexId = makeSaveId();
+  configJson["symbol_index_id"] = symbolIndexId;
+  std::vector<ObjectSpan> spans;
 
-  std::vector<json::json> objectsJson;
-  for (const auto &obj : objects)
-    if (obj.getState() != ObjectState::Removed) objectsJson.push_back(obj.getObjectAsJSON());
-  configJson["objects"] = objectsJson;
+  configJson["object_store"] = StoreFormatStringMap.at(storeFormat_);
+  fs::path storePath = getObjectStorePath();
+  fs::path shardsPath = getShardStorePath();
+  std::error_code ec;
+  // held until the config is written, so that the config and the manifest come from the same save
+  FileLock storeLock;
+  if (storeFormat_ == StoreFormat::Binary) {
+    auto storeResult = ObjectStore::save(storePath, objects, &spans);
+    if (!storeResult) return std::unexpected(storeResult.error());
+    configJson["objects_file"] = storePath.filename().string();
+  } else if (storeFormat_ == StoreFormat::Sharded) {
+    auto lockResult = ShardedStore::lock(shardsPath, true);
+    if (!lockResult) return std::unexpected(lockResult.error());
+    storeLock = std::move(lockResult.value());
+    auto shardsResult = ShardedStore::save(shardsPath, objects);
+    if (!shardsResult) return std::unexpected(shardsResult.error());
+    spdlog::info("Wrote {} changed shards to {}", shardsResult.value(), shardsPath.string());
+    configJson["objects_dir"] = shardsPath.filename().string();
+  }
+  // objects moved to another store, drop the stale ones
+  if (storeFormat_ != StoreFormat::Binary) fs::remove(storePath, ec);
+  if (storeFormat_ != StoreFormat::Sharded && fs::exists(shardsPath / ShardedStore::ManifestName))
+    fs::remove_all(shardsPath, ec);
+
+  ConfigWriter writer(configPath_, compactConfig_);
+  auto beginResult = writer.begin(configJson);
+  if (!beginResult) return std::unexpected(beginResult.error());
+  if (storeFormat_ == StoreFormat::Json) {
+    spans.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+      if (objects[i].getState() != ObjectState::Removed) spans[i] = writer.writeObject(objects[i]);
+  }
+  auto commitResult = writer.commit();
+  if (!commitResult) return commitResult;
 
-  std::ofstream configFile(configPath_);
-  if (!configFile.is_open()) return std::unexpected("Failed to open config file for writing");
-  configFile << configJson.dump(4);
-  configFile.close();
+  // lookups answer from the index, a failure only costs them a full load of the saved objects
+  auto indexResult = SymbolIndex::build(objects, spans).save(getSymbolIndexPath(), symbolIndexId);
+  if (!indexResult) spdlog::warn("Failed to save symbol index: {}", indexResult.error());
   return {};
 }
 
 auto FilesManager::loadConfig() -> std::expected<void, std::string> {
   if (!fs::exists(configPath_)) return std::unexpected("Config file does not exist");
-  std::ifstream configFile(configPath_);
+  ScopedTimer timer("store", "loadConfig");
+  AllocationScope allocationScope(Subsystem::Store);
+  std::ifstream configFile(configPath_, std::ios::binary);
   if (!configFile.is_open()) return std::unexpected("Failed to open config file");
-  json::json configJson = json::json::parse(configFile, nullptr, false);
-  if (configJson.is_discarded()) return std::unexpected("Failed to parse config file");
+  // objects are built straight from the token stream, only the small settings part becomes a JSON document
+  json::json configJson;
+  objects_.clear();
+  ConfigSaxHandler handler(configJson, loadObjects_ ? &objects_ : nullptr);
+  if (!json::json::sax_parse(configFile, &handler)) {
+    objects_.clear();
+    return std::unexpected("Failed to parse config file");
+  }
   spdlog::info("Loading config from {}", configPath_.string());
 
   if (configJson.contains("module_path") && configJson["module_path"].is_string()) {
@@ -127,74 +523,175 @@ auto FilesManager::loadConfig() -> std::expected<void, std::string> {
     for (const auto &type : configJson["types_blacklist"])
       if (type.is_string()) typesBlacklist_.push_back(type.get<std::string>());
   }
+  if (configJson.contains("pch_includes") && configJson["pch_includes"].is_array() && pchIncludes_.empty()) {
+    for (const auto &include : configJson["pch_includes"])
+      if (include.is_string()) pchIncludes_.push_back(include.get<std::string>());
+  }
+  if (configJson.contains("compile_commands") && configJson["compile_commands"].is_string() &&
+      compileCommands_.empty())
+    compileCommands_ = fs::path(configJson["compile_commands"].get<std::string>());
+  if (configJson.contains("compile_commands_digest") && configJson["compile_commands_digest"].is_number_unsigned())
+    savedCompileCommandsDigest_ = configJson["compile_commands_digest"].get<uint64_t>();
+  if (configJson.contains("settings_digest") && configJson["settings_digest"].is_number_unsigned())
+    savedSettingsDigest_ = configJson["settings_digest"].get<uint64_t>();
+  if (configJson.contains("symbol_index_id") && configJson["symbol_index_id"].is_number_unsigned())
+    savedSymbolIndexId_ = configJson["symbol_index_id"].get<uint64_t>();
   if (configJson.contains("source_paths") && configJson["source_paths"].is_array()) {
     sourcePaths_.clear();
     for (const auto &path : configJson["source_paths"])
       if (path.is_string()) sourcePaths_.push_back(fs::path(path.get<std::string>()));
   }
   if (sourcePaths_.empty()) return std::unexpected("No source paths found in config");
+  if (configJson.contains("source_roots") && configJson["source_roots"].is_array()) {
+    sourceRoots_.clear();
+    for (const auto &root : configJson["source_roots"])
+      if (root.is_string()) sourceRoots_.push_back(fs::path(root.get<std::string>()));
+  }
 
-  if (configJson.contains("objects") && configJson["objects"].is_array()) {
-    objects_.clear();
-    for (const auto &obj : configJson["objects"])
-      if (obj.is_object()) objects_.emplace_back(Object(obj));
-    if (!objects_.empty()) spdlog::info("Loaded {} objects from config", objects_.size());
+  if (configJson.contains("file_fingerprints") && configJson["file_fingerprints"].is_object()) {
+    savedFingerprints_.clear();
+    for (const auto &[path, fingerprintJson] : configJson["file_fingerprints"].items()) {
+      if (!fingerprintJson.is_object()) continue;
+      FileFingerprint fingerprint;
+      fingerprint.size = fingerprintJson.value("size", uintmax_t{0});
+      fingerprint.mtime = fingerprintJson.value("mtime", int64_t{0});
+      fingerprint.hash = fingerprintJson.value("hash", uint64_t{0});
+      savedFingerprints_[path] = fingerprint;
+    }
   }
+
+  if (configJson.contains("object_store") && configJson["object_store"].is_string() && !storeFormatForced_) {
+    auto format = getStoreFormatFromString(configJson["object_store"].get<std::string>());
+    if (format) storeFormat_ = format.value();
+  }
+  if (configJson.contains("objects_file") && configJson["objects_file"].is_string()) {
+    savedStoreFormat_ = StoreFormat::Binary;
+    savedStorePath_ = configPath_.parent_path() / configJson["objects_file"].get<std::string>();
+  } else if (configJson.contains("objects_dir") && configJson["objects_dir"].is_string()) {
+    savedStoreFormat_ = StoreFormat::Sharded;
+    savedStorePath_ = configPath_.parent_path() / configJson["objects_dir"].get<std::string>();
+  } else {
+    savedStoreFormat_ = StoreFormat::Json;
+    savedStorePath_ = configPath_;
+  }
+  if (!loadObjects_) return {};
+  if (savedStoreFormat_ != StoreFormat::Json) loadStoreObjects();
+  else if (!objects_.empty()) spdlog::info("Loaded {} objects from config", objects_.size());
   return {};
 }
 
-auto FilesManager::isExcludedDir(const fs::path &dirPath) -> bool {
-  return std::any_of(excludeDirs_.begin(), excludeDirs_.end(),
-                     [&](const std::string &excludedDir) { return dirPath.filename() == excludedDir; });
+auto FilesManager::loadStoreObjects() -> void {
+  AllocationScope allocationScope(Subsystem::Store);
+  savedObjectsLoaded_ = true;
+  objects_.clear();
+  if (savedStorePath_.empty()) return;
+  if (savedStoreFormat_ == StoreFormat::Binary) {
+    auto storeResult = ObjectStore::load(savedStorePath_);
+    if (storeResult) {
+      objects_ = std::move(storeResult.value());
+      if (!objects_.empty()) spdlog::info("Loaded {} objects from {}", objects_.size(), savedStorePath_.string());
+    } else {
+      spdlog::warn("Failed to load object store {}: {}", savedStorePath_.string(), storeResult.error());
+      // without their objects, unchanged headers have to be parsed again
+      savedFingerprints_.clear();
+    }
+  } else if (savedStoreFormat_ == StoreFormat::Sharded) {
+    std::vector<std::string> failedHeaders;
+    auto shardsResult = ShardedStore::load(savedStorePath_, failedHeaders);
+    if (shardsResult) {
+      objects_ = std::move(shardsResult.value());
+      if (!objects_.empty()) spdlog::info("Loaded {} objects from {}", objects_.size(), savedStorePath_.string());
+      for (const auto &header : failedHeaders) savedFingerprints_.erase(header);
+    } else {
+      spdlog::warn("Failed to load sharded store {}: {}", savedStorePath_.string(), shardsResult.error());
+      savedFingerprints_.clear();
+    }
+  } else {
+    // objects skipped along with the settings, the config is read again for them
+    std::ifstream configFile(savedStorePath_, std::ios::binary);
+    json::json settings;
+    ConfigSaxHandler handler(settings, &objects_);
+    if (!configFile.is_open() || !json::json::sax_parse(configFile, &handler)) {
+      objects_.clear();
+      spdlog::warn("Failed to load the objects of {}", savedStorePath_.string());
+      savedFingerprints_.clear();
+    } else if (!objects_.empty()) {
+      spdlog::info("Loaded {} objects from config", objects_.size());
+    }
+  }
+}
+
+/**
+ * @brief Hashes a file content with 64-bit FNV-1a, cheap next to a parse and stable across runs and platforms
+ *
+ * @arg filePath
+ *
+ * @return std::optional<uint64_t>
+ */
+static auto hashFileContent(const fs::path &filePath) -> std::optional<uint64_t> {
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file.is_open()) return std::nullopt;
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  char buffer[64 * 1024];
+  while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+    for (std::streamsize i = 0; i < file.gcount(); ++i) {
+      hash ^= static_cast<unsigned char>(buffer[i]);
+      hash *= 0x100000001b3ULL;
+    }
+  }
+  return hash;
+}
+
+auto FilesManager::computeFingerprint(const fs::path &filePath, const FileFingerprint *saved)
+    -> std::optional<FileFingerprint> {
+  std::error_code ec;
+  FileFingerprint fingerprint;
+  fingerprint.size = fs::file_size(filePath, ec);
+  if (ec) return std::nullopt;
+  fingerprint.mtime = fs::last_write_time(filePath, ec).time_since_epoch().count();
+  if (ec) return std::nullopt;
+
+  if (saved && saved->size == fingerprint.size && saved->mtime == fingerprint.mtime) {
+    fingerprint.hash = saved->hash;
+    return fingerprint;
+  }
+  auto hash = hashFileContent(filePath);
+  if (!hash) return std::nullopt;
+  fingerprint.hash = hash.value();
+  return fingerprint;
 }
 
-auto FilesManager::hasHeaderExtension(const fs::path &filePath) -> bool {
-  return std::any_of(headerExtensions_.begin(), headerExtensions_.end(),
-                     [&](const std::string &ext) { return filePath.extension() == ext; });
+auto FilesManager::refreshFingerprints() -> void {
+  fingerprints_.clear();
+  for (const auto &path : sourcePaths_) {
+    auto saved = savedFingerprints_.find(path.string());
+    bool reuseSaved = !fullScan_ && saved != savedFingerprints_.end();
+    auto fingerprint = computeFingerprint(path, reuseSaved ? &saved->second : nullptr);
+    if (fingerprint) fingerprints_[path.string()] = fingerprint.value();
+  }
 }
 
-auto FilesManager::collectPathFiles(std::vector<fs::path> paths) -> std::expected<std::vector<fs::path>, std::string> {
-  std::vector<fs::path> collectedFiles;
+auto FilesManager::collectPathFiles(std::vector<fs::path> paths, const DirectoryWalker::FileCallback &onFileFound)
+    -> std::expected<std::vector<fs::path>, std::string> {
   std::atomic<size_t> filesCount = 0;
+  std::mutex statusMutex;
 
   auto status = bk::Status({
       .message = "Collecting source files...",
       .style = bk::AnimationStyle::Bar,
-      .show = true,
+      // a consumer streaming the files reports its own progress
+      .show = !onFileFound,
   });
 
-  for (const auto &path : paths) {
-    if (!fs::exists(path)) continue;
-    if (fs::is_regular_file(path) && hasHeaderExtension(path)) {
-      collectedFiles.push_back(path);
-      filesCount++;
-      status->message(fmt::format("Collecting source files (found {} files so far)", filesCount.load()));
-      continue;
-    }
-    if (fs::is_directory(path)) {
-      fs::directory_options options = fs::directory_options::skip_permission_denied;
-      if (recursive_) {
-        for (const auto &entry : fs::recursive_directory_iterator(path, options)) {
-          if (fs::is_directory(entry.path()) && isExcludedDir(entry.path())) continue;
-          if (fs::is_regular_file(entry.path()) && hasHeaderExtension(entry.path())) {
-            collectedFiles.push_back(entry.path());
-            filesCount++;
-            status->message(fmt::format("Collecting source files (found {} files so far)", filesCount.load()));
-          }
-        }
-        continue;
-      }
-      for (const auto &entry : fs::directory_iterator(path, options)) {
-        if (fs::is_directory(entry.path()) && isExcludedDir(entry.path())) continue;
-        if (fs::is_regular_file(entry.path()) && hasHeaderExtension(entry.path())) {
-          collectedFiles.push_back(entry.path());
-          filesCount++;
-          status->message(fmt::format("Collecting source files (found {} files so far)", filesCount.load()));
-        }
-      }
-    }
-  }
-  status->message(fmt::format("Collected {} source files", filesCount.load()));
+  DirectoryWalker walker(pathFilter_, headerExtensions_, recursive_);
+  auto collectedFiles = walker.walk(paths, [&](const fs::path &filePath) {
+    size_t count = ++filesCount;
+    if (onFileFound) onFileFound(filePath);
+    // walker threads skip the refresh rather than wait on each other
+    std::unique_lock lock(statusMutex, std::try_to_lock);
+    if (lock.owns_lock()) status->message(fmt::format("Collecting source files (found {} files so far)", count));
+  });
+  status->message(fmt::format("Collected {} source files", collectedFiles.size()));
   status->done();
   return collectedFiles;
-}
\ No newline at end of file
+}
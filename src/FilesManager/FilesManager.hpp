@@ -8,9 +8,20 @@
 #include <expected>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <nlohmann/json.hpp>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 
+#include "CompilationDatabase.hpp"
+#include "ConfigSaxHandler.hpp"
+#include "ConfigWriter.hpp"
+#include "DirectoryWalker.hpp"
+#include "ObjectStore.hpp"
+#include "PathFilter.hpp"
+#include "ShardedStore.hpp"
+#include "SymbolIndex.hpp"
 #include "ObjectsManager/Object.hpp"
 
 using namespace std::chrono_literals;
@@ -18,6 +29,73 @@ namespace fs = std::filesystem;
 namespace json = nlohmann;
 namespace bk = barkeep;
 
+/**
+ * @brief Fingerprint of a source file used to detect unchanged headers between runs
+ *
+ * @struct FileFingerprint
+ */
+struct FileFingerprint {
+  uintmax_t size = 0;
+  int64_t mtime = 0;
+  uint64_t hash = 0;
+};
+
+/**
+ * @brief Formats the saved objects can be stored in
+ *
+ * @enum StoreFormat
+ */
+enum class StoreFormat {
+  Json,
+  Binary,
+  Sharded,
+};
+
+const std::map<StoreFormat, std::string> StoreFormatStringMap = {
+    {StoreFormat::Json, "json"},
+    {StoreFormat::Binary, "binary"},
+    {StoreFormat::Sharded, "sharded"},
+};
+
+/**
+ * @brief Settings of a run given to FilesManager, the settings a config holds are replaced by it when they are loaded
+ *
+ * @struct FilesManagerOptions
+ */
+struct FilesManagerOptions {
+  // configuration file, empty falls back to toxiconf.json in the working directory
+  fs::path configPath;
+  // nothing is written, neither the config nor the saved objects
+  bool noSave = false;
+  // module precompiled before every header
+  fs::path modPath;
+  // source paths to process, empty keeps the ones of the config
+  std::vector<std::string> paths;
+  std::vector<std::string> headerExtensions;
+  // directories or gitignore-style patterns to exclude
+  std::vector<std::string> excludeDirs;
+  // words designating names to ignore
+  std::vector<std::string> wordsBlacklist;
+  // object types to ignore
+  std::vector<std::string> typesBlacklist;
+  // common includes precompiled along with the module
+  std::vector<std::string> pchIncludes;
+  // compile_commands.json, or its directory, giving the flags headers are parsed with, empty keeps the one of the
+  // config
+  std::string compileCommands;
+  bool recursive = true;
+  // saved fingerprints are ignored and every header is parsed again
+  bool fullScan = false;
+  // headers are parsed with the declarations-only profile, saved objects built with the other profile are not reused
+  bool declarationsOnly = false;
+  // "json", "binary" or "sharded", empty keeps the one of the config
+  std::string storeFormat;
+  // the config file is written without indentation
+  bool compactConfig = false;
+  // false skips the saved objects while loading, for runs that only need the settings
+  bool loadObjects = true;
+};
+
 /**
  * @brief Allows file management and backup system management
  *
@@ -26,20 +104,11 @@ namespace bk = barkeep;
 class FilesManager {
  public:
   /**
-   * @brief Constructs a FilesManager with the given parameters
+   * @brief Constructs a FilesManager with the given run settings
    *
-   * @arg configPath Path to the configuration file
-   * @arg noSave If true, the configuration will not be saved after initialization
-   * @arg paths List of source paths to process
-   * @arg defaultHeaderExtensions List of default header file extensions
-   * @arg defaultExcludeDirs List of default directories to exclude
-   * @arg wordsBlacklist List of words to designate names to ignore
-   * @arg typesBlacklist List of object types to ignore
-   * @arg recursive If true, directories will be searched recursively
+   * @arg options
    */
-  FilesManager(fs::path configPath, bool noSave, fs::path modPath, std::vector<std::string> paths,
-               std::vector<std::string> defaultHeaderExtensions, std::vector<std::string> defaultExcludeDirs,
-               std::vector<std::string> wordsBlacklist, std::vector<std::string> typesBlacklist, bool recursive);
+  explicit FilesManager(FilesManagerOptions options);
 
   /**
    * @brief Destructor for FilesManager
@@ -48,8 +117,24 @@ class FilesManager {
 
   /**
    * @brief Initializes the FilesManager by loading configuration and collecting source files
+   *
+   * @param onFileFound optional callback receiving each source file as soon as it is known, called from the walker
+   * threads
+   */
+  auto init(const DirectoryWalker::FileCallback &onFileFound = {}) -> std::expected<void, std::string>;
+
+  /**
+   * @brief First half of init, loads the configuration or keeps the given parameters, no file is collected yet
    */
-  auto init() -> std::expected<void, std::string>;
+  auto initSettings() -> std::expected<void, std::string>;
+
+  /**
+   * @brief Second half of init, collects the source files and computes their fingerprints
+   *
+   * @param onFileFound optional callback receiving each source file as soon as it is known, called from the walker
+   * threads
+   */
+  auto initSources(const DirectoryWalker::FileCallback &onFileFound = {}) -> std::expected<void, std::string>;
 
   /**
    * @brief Gets the module path for clang parsing
@@ -59,12 +144,103 @@ class FilesManager {
   /**
    * @brief Gets the list of source paths
    */
-  auto getSourcePaths() const -> std::vector<fs::path>;
+  auto getSourcePaths() const -> const std::vector<fs::path> &;
+
+  /**
+   * @brief Gets the paths the source files were collected from, empty for a config saved before they were recorded
+   */
+  auto getSourceRoots() const -> const std::vector<fs::path> &;
 
   /**
    * @brief Gets the list of saved objects from the configuration
    */
-  auto getSavedObjects() -> std::vector<Object>;
+  auto getSavedObjects() const -> const std::vector<Object> &;
+
+  /**
+   * @brief Gets the saved objects of every source file whose fingerprint did not change since the last save, keyed by
+   * file path
+   */
+  auto getUnchangedFilesObjects() const -> std::unordered_map<std::string, std::vector<Object>>;
+
+  /**
+   * @brief Gets the saved objects of a single file if its content did not change since the last save, safe to call
+   * from several threads once the settings are loaded
+   *
+   * @param filePath Path of the file
+   */
+  auto getUnchangedFileObjects(const fs::path &filePath) const -> std::optional<std::vector<Object>>;
+
+  /**
+   * @brief Gets the saved objects of a single file
+   *
+   * @param filePath Path of the file
+   */
+  auto getSavedFileObjects(const fs::path &filePath) const -> std::vector<Object>;
+
+  /**
+   * @brief Gets the saved objects of a single file, when the saved objects were skipped while loading only the ones of
+   * this file are read, from its shard or from the locations kept by the symbol index
+   *
+   * @param filePath Path of the file
+   */
+  auto loadSavedFileObjects(const fs::path &filePath) -> std::vector<Object>;
+
+  /**
+   * @brief Gets the source files that have to be parsed again, their content changed or they were never saved
+   */
+  auto getStaleFiles() const -> std::vector<fs::path>;
+
+  /**
+   * @brief Gets the name index of the saved objects, loaded from the index file saved along with them or built from
+   * the saved objects when that file is missing or out of date, the saved objects are then loaded if they were skipped
+   */
+  auto loadSymbolIndex() -> const SymbolIndex &;
+
+  /**
+   * @brief Gets the paths of every file holding saved objects, in the order of their first saved object
+   */
+  auto getSavedObjectFiles() const -> std::vector<std::string>;
+
+  /**
+   * @brief Releases the saved objects and their index once they were merged into the current objects, for a process
+   * that only keeps the current ones
+   */
+  auto dropSavedObjects() -> void;
+
+  /**
+   * @brief Tells if a path found after the walk would have been collected, a header or a directory the walk would
+   * enter under one of the source roots. The exclude patterns are matched against the path relative to its root, or
+   * against its name alone when the roots are unknown
+   *
+   * @param path Path of the file or directory, its parent directories are assumed accepted
+   * @param isDirectory Whether the path is a directory
+   */
+  auto acceptsPath(const fs::path &path, bool isDirectory) const -> bool;
+
+  /**
+   * @brief Adds a source file if it is new and refreshes its fingerprint
+   *
+   * @param filePath Path of the file
+   *
+   * @return true if the file is new or its content changed
+   */
+  auto updateSourceFile(const fs::path &filePath) -> bool;
+
+  /**
+   * @brief Removes a source file and its fingerprint
+   *
+   * @param filePath Path of the file
+   *
+   * @return true if the file was a source file
+   */
+  auto removeSourceFile(const fs::path &filePath) -> bool;
+
+  /**
+   * @brief Drops the fingerprint of a file so it is parsed again on the next run
+   *
+   * @param filePath Path of the file
+   */
+  auto invalidateFingerprint(const fs::path &filePath) -> void;
 
   /**
    * @brief Gets the blacklist of words we want to ignore
@@ -76,55 +252,160 @@ class FilesManager {
    */
   auto getTypesBlacklist() const -> std::vector<std::string>;
 
+  /**
+   * @brief Gets the list of common includes to precompile
+   */
+  auto getPchIncludes() const -> std::vector<std::string>;
+
+  /**
+   * @brief Gets the compilation database loaded by initSettings
+   *
+   * @return nullptr when no compilation database is configured
+   */
+  auto getCompilationDatabase() const -> const CompilationDatabase *;
+
+  /**
+   * @brief Gets the path of the config file, the default one when none was given
+   */
+  auto getConfigPath() const -> fs::path;
+
+  /**
+   * @brief Gets the path of the precompiled header, stored next to the config file
+   */
+  auto getPrecompiledHeaderPath() const -> fs::path;
+
+  /**
+   * @brief Gets the path of the binary object store, stored next to the config file
+   */
+  auto getObjectStorePath() const -> fs::path;
+
+  /**
+   * @brief Gets the directory of the sharded object store, one record per header, stored next to the config file
+   */
+  auto getShardStorePath() const -> fs::path;
+
+  /**
+   * @brief Gets the path of the symbol index of the saved objects, stored next to the config file
+   */
+  auto getSymbolIndexPath() const -> fs::path;
+
   /**
    * @brief Gets the last save time of the configuration
    */
   auto getLastSaveTime() const -> std::chrono::system_clock::time_point;
 
   /**
-   * @brief Saves the current configuration to the config file
+   * @brief Saves the current configuration to the config file, objects are streamed to a temporary file renamed over
+   * the config once complete
    *
-   * @param objects List of objects to save
+   * @param objects List of objects to save, removed objects are skipped
    */
-  auto saveConfig(std::vector<Object> objects = {}) -> std::expected<void, std::string>;
+  auto saveConfig(const std::vector<Object> &objects = {}) -> std::expected<void, std::string>;
 
  private:
+  /**
+   * @brief Loads the given config or the default one
+   *
+   * @return true if a config was loaded, its source paths are then files and need no walk
+   */
+  auto loadSettings() -> bool;
+
+  /**
+   * @brief Loads the configured compilation database, saved objects are dropped when its flags changed since the last
+   * save since headers may then parse differently. A database that cannot be loaded leaves the default flags
+   */
+  auto loadCompilationDatabase() -> void;
+
+  /**
+   * @brief Hashes the settings the saved objects depend on, the module, the blacklists and the parse profile
+   */
+  auto getSettingsDigest() const -> uint64_t;
+
+  /**
+   * @brief Groups the indexes of the saved objects by file path
+   */
+  auto indexSavedObjects() -> void;
+
   /**
    * @brief Loads the configuration from the config file
    */
   auto loadConfig() -> std::expected<void, std::string>;
 
   /**
-   * @brief Checks if a directory is in the exclude list
+   * @brief Loads every saved object from the store the config points to, headers whose objects cannot be read lose
+   * their fingerprint
+   */
+  auto loadStoreObjects() -> void;
+
+  /**
+   * @brief Reads the saved objects of a single file from the store without loading the others
    *
-   * @param dirPath Path to the directory to check
+   * @param filePath Path of the file
    */
-  auto isExcludedDir(const fs::path &dirPath) -> bool;
+  auto readSavedFileObjects(const std::string &filePath) -> std::expected<std::vector<Object>, std::string>;
 
   /**
-   * @brief Checks if a file has a header file extension
+   * @brief Tells if a source file kept the content it had on the last save, always false on a full scan
    *
-   * @param filePath Path to the file to check
+   * @param filePath Path of the file
+   */
+  auto isFileUnchanged(const std::string &filePath) const -> bool;
+
+  /**
+   * @brief Computes the fingerprint of a file, the content is hashed only when size or mtime moved from the saved one
+   *
+   * @param filePath Path of the file
+   * @param saved Saved fingerprint of the file, nullptr always hashes the content
+   */
+  static auto computeFingerprint(const fs::path &filePath, const FileFingerprint *saved)
+      -> std::optional<FileFingerprint>;
+
+  /**
+   * @brief Computes the fingerprint of every collected source file, hashing content only when size or mtime moved
    */
-  auto hasHeaderExtension(const fs::path &filePath) -> bool;
+  auto refreshFingerprints() -> void;
 
   /**
-   * @brief Collects all header files from the given paths
+   * @brief Collects all header files from the given paths with the parallel walker, excluded subtrees are pruned
    *
    * @param paths List of paths to collect files from
+   * @param onFileFound optional callback receiving each file as soon as it is found
    */
-  auto collectPathFiles(std::vector<fs::path> paths) -> std::expected<std::vector<fs::path>, std::string>;
+  auto collectPathFiles(std::vector<fs::path> paths, const DirectoryWalker::FileCallback &onFileFound)
+      -> std::expected<std::vector<fs::path>, std::string>;
 
   bool recursive_;
   bool noSave_;
+  bool loadObjects_;
+  bool fullScan_;
+  bool declarationsOnly_;
+  bool compactConfig_;
+  bool sourcesFromConfig_;
+  bool storeFormatForced_;
+  StoreFormat storeFormat_;
   std::vector<fs::path> sourcePaths_;
+  std::vector<fs::path> sourceRoots_;
   fs::path configPath_;
   fs::path modPath_;
   std::vector<std::string> excludeDirs_;
+  PathFilter pathFilter_;
   std::vector<std::string> headerExtensions_;
   std::vector<std::string> wordsBlacklist_;
   std::vector<std::string> typesBlacklist_;
+  std::vector<std::string> pchIncludes_;
+  fs::path compileCommands_;
+  std::optional<CompilationDatabase> compilationDatabase_;
+  uint64_t savedCompileCommandsDigest_;
+  uint64_t savedSymbolIndexId_;
+  uint64_t savedSettingsDigest_;
+  StoreFormat savedStoreFormat_;
+  fs::path savedStorePath_;
+  bool savedObjectsLoaded_;
+  std::optional<SymbolIndex> symbolIndex_;
   std::vector<Object> objects_;
+  std::unordered_map<std::string, std::vector<size_t>> savedObjectsByFile_;
+  std::unordered_map<std::string, FileFingerprint> savedFingerprints_;
+  std::unordered_map<std::string, FileFingerprint> fingerprints_;
   std::chrono::system_clock::time_point lastSaveTime_;
 };
 
@@ -0,0 +1,70 @@
+#include "MappedFile.hpp"
+
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+
+auto MappedFile::operator=(MappedFile &&other) noexcept -> MappedFile & {
+  if (this == &other) return *this;
+  release();
+  mapped_ = other.mapped_;
+  size_ = other.size_;
+  buffer_ = std::move(other.buffer_);
+  data_ = mapped_ ? other.data_ : buffer_.data();
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.mapped_ = false;
+  return *this;
+}
+
+MappedFile::~MappedFile() { release(); }
+
+auto MappedFile::open(const fs::path &filePath) -> std::expected<MappedFile, std::string> {
+  MappedFile file;
+#if !defined(_WIN32)
+  int fd = ::open(filePath.c_str(), O_RDONLY);
+  if (fd < 0) return std::unexpected("Failed to open " + filePath.string());
+  struct stat fileStat;
+  if (::fstat(fd, &fileStat) != 0) {
+    ::close(fd);
+    return std::unexpected("Failed to stat " + filePath.string());
+  }
+  file.size_ = static_cast<size_t>(fileStat.st_size);
+  // mmap refuses empty lengths, an empty file is simply an empty view
+  if (file.size_ > 0) {
+    void *address = ::mmap(nullptr, file.size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address != MAP_FAILED) {
+      ::madvise(address, file.size_, MADV_SEQUENTIAL);
+      file.data_ = static_cast<const char *>(address);
+      file.mapped_ = true;
+    }
+  }
+  ::close(fd);
+  if (file.mapped_ || file.size_ == 0) return file;
+#endif
+  std::ifstream input(filePath, std::ios::binary);
+  if (!input.is_open()) return std::unexpected("Failed to open " + filePath.string());
+  file.buffer_.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+  file.data_ = file.buffer_.data();
+  file.size_ = file.buffer_.size();
+  return file;
+}
+
+auto MappedFile::view() const -> std::string_view { return data_ ? std::string_view(data_, size_) : std::string_view(); }
+
+auto MappedFile::release() -> void {
+#if !defined(_WIN32)
+  if (mapped_ && data_) ::munmap(const_cast<char *>(data_), size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+  mapped_ = false;
+  buffer_.clear();
+}
@@ -0,0 +1,77 @@
+#ifndef MAPPEDFILE_HPP_
+#define MAPPEDFILE_HPP_
+
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Read-only view of a whole file, memory-mapped where the platform allows it
+ *
+ * @class MappedFile
+ */
+class MappedFile {
+ public:
+  /**
+   * @brief Constructs an empty MappedFile
+   */
+  MappedFile() = default;
+
+  MappedFile(const MappedFile &) = delete;
+  auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+  /**
+   * @brief Move constructor, the mapping is transferred
+   *
+   * @arg other
+   */
+  MappedFile(MappedFile &&other) noexcept;
+
+  /**
+   * @brief Move assignment, the current mapping is released first
+   *
+   * @arg other
+   *
+   * @return MappedFile &
+   */
+  auto operator=(MappedFile &&other) noexcept -> MappedFile &;
+
+  /**
+   * @brief Destructor for MappedFile, unmaps the file
+   */
+  ~MappedFile();
+
+  /**
+   * @brief Maps a file in memory, falls back to reading it when mapping is not available
+   *
+   * @arg filePath
+   *
+   * @return std::expected<MappedFile, std::string>
+   */
+  static auto open(const fs::path &filePath) -> std::expected<MappedFile, std::string>;
+
+  /**
+   * @brief gets the content of the file
+   *
+   * @return std::string_view
+   */
+  auto view() const -> std::string_view;
+
+ private:
+  /**
+   * @brief Releases the mapping or the fallback buffer
+   *
+   * @return void
+   */
+  auto release() -> void;
+
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  std::string buffer_;
+};
+
+#endif /* !MAPPEDFILE_HPP_ */
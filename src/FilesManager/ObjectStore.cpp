@@ -0,0 +1,216 @@
+#include "ObjectStore.hpp"
+
+#include "AtomicFile.hpp"
+#include "MappedFile.hpp"
+
+/**
+ * @brief Interns strings while objects are serialized
+ *
+ * @struct StringTable
+ */
+struct StringTable {
+  std::unordered_map<std::string_view, uint32_t> indexes;
+  std::vector<std::string_view> strings;
+
+  auto intern(std::string_view str) -> uint32_t {
+    auto [it, inserted] = indexes.emplace(str, static_cast<uint32_t>(strings.size()));
+    if (inserted) strings.push_back(str);
+    return it->second;
+  }
+};
+
+static auto appendU32(std::string &out, uint32_t value) -> void {
+  char bytes[4] = {static_cast<char>(value & 0xff), static_cast<char>((value >> 8) & 0xff),
+                   static_cast<char>((value >> 16) & 0xff), static_cast<char>((value >> 24) & 0xff)};
+  out.append(bytes, sizeof(bytes));
+}
+
+/**
+ * @brief Bounds-checked reader over the binary layout
+ *
+ * @struct StoreReader
+ */
+struct StoreReader {
+  std::string_view data;
+  size_t pos = 0;
+  bool failed = false;
+
+  auto readU32() -> uint32_t {
+    if (failed || data.size() - pos < 4) {
+      failed = true;
+      return 0;
+    }
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data.data() + pos);
+    pos += 4;
+    return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+           static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+  }
+
+  auto readBytes(size_t length) -> std::string_view {
+    if (failed || data.size() - pos < length) {
+      failed = true;
+      return {};
+    }
+    std::string_view bytes = data.substr(pos, length);
+    pos += length;
+    return bytes;
+  }
+};
+
+/**
+ * @brief Reads the string table of a store, the strings are views into the store data
+ *
+ * @arg reader positioned after the version
+ * @arg strings receives the strings
+ *
+ * @return void
+ */
+static auto readStringTable(StoreReader &reader, std::vector<std::string_view> &strings) -> void {
+  uint32_t stringCount = reader.readU32();
+  strings.reserve(std::min<size_t>(stringCount, reader.data.size() / 4));
+  for (uint32_t i = 0; i < stringCount && !reader.failed; ++i) strings.push_back(reader.readBytes(reader.readU32()));
+}
+
+/**
+ * @brief Reads one object record, its strings are interned as the fields are read
+ *
+ * @arg reader positioned at the record
+ * @arg strings string table of the store
+ * @arg obj receives the fields
+ *
+ * @return void
+ */
+static auto readObject(StoreReader &reader, const std::vector<std::string_view> &strings, Object &obj) -> void {
+  StringPool &pool = StringPool::global();
+  auto string = [&](uint32_t index) -> std::string_view {
+    if (index >= strings.size()) {
+      reader.failed = true;
+      return {};
+    }
+    return strings[index];
+  };
+  Object::visitFields(obj, [&](std::string_view /*key*/, auto &field) {
+    using Field = std::remove_cvref_t<decltype(field)>;
+    if constexpr (std::is_same_v<Field, std::string_view>) {
+      field = pool.intern(string(reader.readU32()));
+    } else if constexpr (std::is_same_v<Field, uint32_t>) {
+      field = reader.readU32();
+    } else if constexpr (std::is_same_v<Field, ObjectType>) {
+      uint32_t type = reader.readU32();
+      field = type > static_cast<uint32_t>(ObjectType::Macro) ? ObjectType::Unknown : static_cast<ObjectType>(type);
+    } else {
+      uint32_t argumentCount = reader.readU32();
+      std::vector<std::string_view> arguments;
+      for (uint32_t arg = 0; arg < argumentCount && !reader.failed; ++arg)
+        arguments.push_back(pool.intern(string(reader.readU32())));
+      field = pool.internList(arguments);
+    }
+  });
+}
+
+auto ObjectStore::serialize(const std::vector<Object> &objects, std::vector<ObjectSpan> *spans) -> std::string {
+  std::vector<const Object *> pointers;
+  pointers.reserve(objects.size());
+  for (const auto &obj : objects) pointers.push_back(&obj);
+  return serialize(pointers, spans);
+}
+
+auto ObjectStore::serialize(const std::vector<const Object *> &objects, std::vector<ObjectSpan> *spans)
+    -> std::string {
+  // removed objects are not stored, same as in the JSON config
+  size_t keptCount = 0;
+  for (const Object *obj : objects)
+    if (obj->getState() != ObjectState::Removed) keptCount++;
+  if (spans) spans->assign(objects.size(), ObjectSpan{});
+
+  StringTable table;
+  std::string body;
+  appendU32(body, static_cast<uint32_t>(keptCount));
+  for (size_t i = 0; i < objects.size(); ++i) {
+    if (objects[i]->getState() == ObjectState::Removed) continue;
+    size_t recordStart = body.size();
+    Object::visitFields(*objects[i], [&body, &table](std::string_view /*key*/, const auto &field) {
+      using Field = std::remove_cvref_t<decltype(field)>;
+      if constexpr (std::is_same_v<Field, std::string_view>) {
+        appendU32(body, table.intern(field));
+      } else if constexpr (std::is_same_v<Field, uint32_t>) {
+        appendU32(body, field);
+      } else if constexpr (std::is_same_v<Field, ObjectType>) {
+        appendU32(body, static_cast<uint32_t>(field));
+      } else {
+        appendU32(body, static_cast<uint32_t>(field->size()));
+        for (std::string_view arg : *field) appendU32(body, table.intern(arg));
+      }
+    });
+    // offsets are taken in the body for now, the string table is only known once every object is written
+    if (spans) (*spans)[i] = {recordStart, static_cast<uint32_t>(body.size() - recordStart)};
+  }
+
+  std::string out(Magic);
+  appendU32(out, Version);
+  appendU32(out, static_cast<uint32_t>(table.strings.size()));
+  for (const auto &str : table.strings) {
+    appendU32(out, static_cast<uint32_t>(str.size()));
+    out.append(str);
+  }
+  if (spans)
+    for (size_t i = 0; i < objects.size(); ++i)
+      if (objects[i]->getState() != ObjectState::Removed) (*spans)[i].offset += out.size();
+  out += body;
+  return out;
+}
+
+auto ObjectStore::deserialize(std::string_view data) -> std::expected<std::vector<Object>, std::string> {
+  StoreReader reader{data};
+  if (reader.readBytes(Magic.size()) != Magic) return std::unexpected("Not a Toxidoc object store");
+  if (reader.readU32() != Version) return std::unexpected("Unsupported object store version");
+
+  // views into the store, interned as the fields are read
+  std::vector<std::string_view> strings;
+  readStringTable(reader, strings);
+  if (reader.failed) return std::unexpected("Truncated object store string table");
+
+  uint32_t objectCount = reader.readU32();
+  std::vector<Object> objects;
+  objects.reserve(std::min<size_t>(objectCount, data.size() / 4));
+  for (uint32_t i = 0; i < objectCount && !reader.failed; ++i) readObject(reader, strings, objects.emplace_back());
+  if (reader.failed) return std::unexpected("Truncated object store");
+  return objects;
+}
+
+auto ObjectStore::save(const fs::path &storePath, const std::vector<Object> &objects, std::vector<ObjectSpan> *spans)
+    -> std::expected<void, std::string> {
+  return AtomicFile::write(storePath, serialize(objects, spans));
+}
+
+auto ObjectStore::load(const fs::path &storePath) -> std::expected<std::vector<Object>, std::string> {
+  auto mapResult = MappedFile::open(storePath);
+  if (!mapResult) return std::unexpected(mapResult.error());
+  return deserialize(mapResult->view());
+}
+
+auto ObjectStore::loadSpans(const fs::path &storePath, const std::vector<ObjectSpan> &spans)
+    -> std::expected<std::vector<Object>, std::string> {
+  auto mapResult = MappedFile::open(storePath);
+  if (!mapResult) return std::unexpected(mapResult.error());
+  std::string_view data = mapResult->view();
+  StoreReader reader{data};
+  if (reader.readBytes(Magic.size()) != Magic) return std::unexpected("Not a Toxidoc object store");
+  if (reader.readU32() != Version) return std::unexpected("Unsupported object store version");
+  // the whole table is walked but only the strings of the loaded objects are interned
+  std::vector<std::string_view> strings;
+  readStringTable(reader, strings);
+  if (reader.failed) return std::unexpected("Truncated object store string table");
+
+  std::vector<Object> objects;
+  objects.reserve(spans.size());
+  for (const auto &span : spans) {
+    if (span.offset < reader.pos || span.offset > data.size() || data.size() - span.offset < span.length)
+      return std::unexpected("Object location out of the object store");
+    StoreReader objectReader{data.substr(span.offset, span.length)};
+    readObject(objectReader, strings, objects.emplace_back());
+    if (objectReader.failed || objectReader.pos != span.length)
+      return std::unexpected("Object location does not match the object store");
+  }
+  return objects;
+}
@@ -0,0 +1,106 @@
+#ifndef OBJECTSTORE_HPP_
+#define OBJECTSTORE_HPP_
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ObjectsManager/Object.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Location of one serialized object inside a store file, the symbol index keeps them so a lookup reads the
+ * objects of the matched files only
+ *
+ * @struct ObjectSpan
+ */
+struct ObjectSpan {
+  uint64_t offset = 0;
+  uint32_t length = 0;
+};
+
+/**
+ * @brief Compact binary store for objects, strings are interned once in a table and objects refer to them by index
+ *
+ * Layout: "TXDC" magic, u32 version, u32 string count then each string as u32 length + bytes, u32 object count then
+ * each object as u32 fields in the order of Object::visitFields (string indexes, type, overload index, positions,
+ * argument count + indexes). Integers are little-endian
+ *
+ * @class ObjectStore
+ */
+class ObjectStore {
+ public:
+  /**
+   * @brief Writes objects to a binary store, through a temporary file renamed over the target
+   *
+   * @arg storePath
+   * @arg objects
+   * @arg spans optional, receives the location of each object in the store, empty for removed objects
+   *
+   * @return std::expected<void, std::string>
+   */
+  static auto save(const fs::path &storePath, const std::vector<Object> &objects,
+                   std::vector<ObjectSpan> *spans = nullptr) -> std::expected<void, std::string>;
+
+  /**
+   * @brief Loads objects from a binary store through a memory map
+   *
+   * @arg storePath
+   *
+   * @return std::expected<std::vector<Object>, std::string>
+   */
+  static auto load(const fs::path &storePath) -> std::expected<std::vector<Object>, std::string>;
+
+  /**
+   * @brief Loads the objects found at the given locations of a binary store, the other objects are not read
+   *
+   * @arg storePath
+   * @arg spans locations given by save
+   *
+   * @return std::expected<std::vector<Object>, std::string> objects in the order of the spans, an error when a span
+   * does not hold an object of the store
+   */
+  static auto loadSpans(const fs::path &storePath, const std::vector<ObjectSpan> &spans)
+      -> std::expected<std::vector<Object>, std::string>;
+
+  /**
+   * @brief Serializes objects to the binary layout, objects in the Removed state are skipped
+   *
+   * @arg objects
+   * @arg spans optional, receives the location of each object in the output, empty for removed objects
+   *
+   * @return std::string
+   */
+  static auto serialize(const std::vector<Object> &objects, std::vector<ObjectSpan> *spans = nullptr) -> std::string;
+
+  /**
+   * @brief Serializes the pointed objects to the binary layout, objects in the Removed state are skipped
+   *
+   * @arg objects
+   * @arg spans optional, receives the location of each object in the output, empty for removed objects
+   *
+   * @return std::string
+   */
+  static auto serialize(const std::vector<const Object *> &objects, std::vector<ObjectSpan> *spans = nullptr)
+      -> std::string;
+
+  /**
+   * @brief Parses objects from the binary layout
+   *
+   * @arg data
+   *
+   * @return std::expected<std::vector<Object>, std::string>
+   */
+  static auto deserialize(std::string_view data) -> std::expected<std::vector<Object>, std::string>;
+
+ private:
+  static constexpr std::string_view Magic = "TXDC";
+  static constexpr uint32_t Version = 2;
+};
+
+#endif /* !OBJECTSTORE_HPP_ */
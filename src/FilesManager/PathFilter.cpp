@@ -0,0 +1,134 @@
+#include "PathFilter.hpp"
+
+PathFilter::PathFilter(const std::vector<std::string> &patterns) {
+  for (const auto &pattern : patterns) {
+    std::string_view text = pattern;
+    if (text.empty() || text.front() == '#') continue;
+
+    Rule rule;
+    if (text.front() == '!') {
+      rule.negated = true;
+      text.remove_prefix(1);
+    }
+    if (!text.empty() && text.back() == '/') {
+      rule.directoryOnly = true;
+      text.remove_suffix(1);
+    }
+    // a slash left at the start or in the middle anchors the pattern to the root
+    rule.anchored = text.find('/') != std::string_view::npos;
+    if (!text.empty() && text.front() == '/') text.remove_prefix(1);
+
+    size_t start = 0;
+    while (start <= text.size()) {
+      size_t end = text.find('/', start);
+      if (end == std::string_view::npos) end = text.size();
+      std::string_view segment = text.substr(start, end - start);
+      // consecutive "**" are equivalent to a single one
+      if (!segment.empty() && !(segment == "**" && !rule.segments.empty() && rule.segments.back() == "**"))
+        rule.segments.emplace_back(segment);
+      start = end + 1;
+    }
+    if (rule.segments.empty()) continue;
+    rules_.push_back(std::move(rule));
+  }
+}
+
+auto PathFilter::empty() const -> bool { return rules_.empty(); }
+
+auto PathFilter::matchSegment(std::string_view glob, std::string_view name) -> bool {
+  size_t g = 0, n = 0;
+  size_t starGlob = std::string_view::npos, starName = 0;
+  while (n < name.size()) {
+    if (g < glob.size()) {
+      char c = glob[g];
+      if (c == '*') {
+        starGlob = g++;
+        starName = n;
+        continue;
+      }
+      if (c == '?') {
+        ++g;
+        ++n;
+        continue;
+      }
+      if (c == '[') {
+        size_t i = g + 1;
+        bool negate = i < glob.size() && (glob[i] == '!' || glob[i] == '^');
+        if (negate) ++i;
+        bool matched = false;
+        size_t first = i;
+        while (i < glob.size() && (glob[i] != ']' || i == first)) {
+          if (i + 2 < glob.size() && glob[i + 1] == '-' && glob[i + 2] != ']') {
+            matched |= glob[i] <= name[n] && name[n] <= glob[i + 2];
+            i += 3;
+          } else {
+            matched |= glob[i] == name[n];
+            ++i;
+          }
+        }
+        // an unterminated class is matched as a literal bracket
+        if (i >= glob.size()) {
+          if (name[n] == '[') {
+            ++g;
+            ++n;
+            continue;
+          }
+        } else if (matched != negate) {
+          g = i + 1;
+          ++n;
+          continue;
+        }
+      } else {
+        size_t next = g;
+        if (c == '\\' && g + 1 < glob.size()) c = glob[++next];
+        if (c == name[n]) {
+          g = next + 1;
+          ++n;
+          continue;
+        }
+      }
+    }
+    // mismatch, let the last star absorb one more character
+    if (starGlob == std::string_view::npos) return false;
+    g = starGlob + 1;
+    n = ++starName;
+  }
+  while (g < glob.size() && glob[g] == '*') ++g;
+  return g == glob.size();
+}
+
+auto PathFilter::matchSegments(std::span<const std::string> segments, std::span<const std::string_view> components)
+    -> bool {
+  if (segments.empty()) return components.empty();
+  if (segments.front() == "**") {
+    for (size_t skip = 0; skip <= components.size(); ++skip)
+      if (matchSegments(segments.subspan(1), components.subspan(skip))) return true;
+    return false;
+  }
+  if (components.empty() || !matchSegment(segments.front(), components.front())) return false;
+  return matchSegments(segments.subspan(1), components.subspan(1));
+}
+
+auto PathFilter::isExcluded(std::string_view relativePath, bool isDirectory) const -> bool {
+  if (rules_.empty() || relativePath.empty()) return false;
+
+  std::vector<std::string_view> components;
+  size_t start = 0;
+  while (start <= relativePath.size()) {
+    size_t end = relativePath.find('/', start);
+    if (end == std::string_view::npos) end = relativePath.size();
+    if (end > start) components.push_back(relativePath.substr(start, end - start));
+    start = end + 1;
+  }
+  if (components.empty()) return false;
+
+  bool excluded = false;
+  for (const auto &rule : rules_) {
+    if (rule.directoryOnly && !isDirectory) continue;
+    if (rule.negated != excluded) continue;  // the rule could not change the outcome
+    bool matched = rule.anchored ? matchSegments(rule.segments, components)
+                                 : matchSegment(rule.segments.front(), components.back());
+    if (matched) excluded = !rule.negated;
+  }
+  return excluded;
+}
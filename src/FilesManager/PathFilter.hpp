@@ -0,0 +1,87 @@
+#ifndef PATHFILTER_HPP_
+#define PATHFILTER_HPP_
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Gitignore-style exclude patterns, compiled once and matched against paths relative to a walk root
+ *
+ * A pattern without a slash (e.g. "build", "*.gen.hpp") matches the name of any entry at any depth, a pattern with a
+ * slash (e.g. "src/third_party") is anchored to the walk root. "*", "?" and "[a-z]" match within a path component,
+ * a "**" component matches any number of components, a trailing slash restricts the pattern to directories and a
+ * leading "!" re-includes what earlier patterns excluded. The last matching pattern wins
+ *
+ * @class PathFilter
+ */
+class PathFilter {
+ public:
+  /**
+   * @brief Constructs an empty PathFilter that excludes nothing
+   */
+  PathFilter() = default;
+
+  /**
+   * @brief Compiles the given patterns, empty patterns and "#" comments are ignored
+   *
+   * @arg patterns
+   */
+  explicit PathFilter(const std::vector<std::string> &patterns);
+
+  /**
+   * @brief Checks whether an entry is excluded
+   *
+   * @arg relativePath path relative to the walk root, components separated by "/"
+   * @arg isDirectory whether the entry is a directory
+   *
+   * @return bool
+   */
+  auto isExcluded(std::string_view relativePath, bool isDirectory) const -> bool;
+
+  /**
+   * @brief Checks whether no pattern was compiled
+   *
+   * @return bool
+   */
+  auto empty() const -> bool;
+
+ private:
+  /**
+   * @brief Pattern split in path components
+   *
+   * @struct Rule
+   */
+  struct Rule {
+    std::vector<std::string> segments;
+    bool anchored = false;
+    bool directoryOnly = false;
+    bool negated = false;
+  };
+
+  /**
+   * @brief Matches a path component against a glob segment
+   *
+   * @arg glob
+   * @arg name
+   *
+   * @return bool
+   */
+  static auto matchSegment(std::string_view glob, std::string_view name) -> bool;
+
+  /**
+   * @brief Matches path components against rule segments, "**" segments absorb any number of components
+   *
+   * @arg segments
+   * @arg components
+   *
+   * @return bool
+   */
+  static auto matchSegments(std::span<const std::string> segments, std::span<const std::string_view> components)
+      -> bool;
+
+  std::vector<Rule> rules_;
+};
+
+#endif /* !PATHFILTER_HPP_ */
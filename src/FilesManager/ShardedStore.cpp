@@ -0,0 +1,193 @@
+#include "ShardedStore.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <unordered_map>
+
+#include "AtomicFile.hpp"
+#include "FileLock.hpp"
+#include "MappedFile.hpp"
+#include "Profiler/AllocationTracker.hpp"
+
+namespace json = nlohmann;
+
+/**
+ * @brief Hashes bytes with 64-bit FNV-1a, used for shard names and content digests
+ *
+ * @arg data
+ *
+ * @return uint64_t
+ */
+static auto hashBytes(std::string_view data) -> uint64_t {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/**
+ * @brief Loads the objects of one shard, checked against the digest of its manifest entry
+ *
+ * @arg storeDir
+ * @arg entry
+ *
+ * @return std::expected<std::vector<Object>, std::string>
+ */
+static auto loadShard(const fs::path &storeDir, const ShardEntry &entry)
+    -> std::expected<std::vector<Object>, std::string> {
+  auto mapResult = MappedFile::open(storeDir / entry.file);
+  if (!mapResult) return std::unexpected(mapResult.error());
+  // a shard replaced by another run after the manifest was read does not match its digest
+  if (hashBytes(mapResult->view()) != entry.digest) return std::unexpected("Shard does not match the manifest");
+  return ObjectStore::deserialize(mapResult->view());
+}
+
+auto ShardedStore::getShardFileName(const std::string &headerPath) -> std::string {
+  return fmt::format("{:016x}.bin", hashBytes(headerPath));
+}
+
+auto ShardedStore::loadManifest(const fs::path &storeDir)
+    -> std::expected<std::map<std::string, ShardEntry>, std::string> {
+  std::map<std::string, ShardEntry> manifest;
+  fs::path manifestPath = storeDir / ManifestName;
+  if (!fs::exists(manifestPath)) return manifest;
+
+  std::ifstream manifestFile(manifestPath, std::ios::binary);
+  if (!manifestFile.is_open()) return std::unexpected("Failed to open shard manifest");
+  json::json manifestJson = json::json::parse(manifestFile, nullptr, false);
+  if (manifestJson.is_discarded() || !manifestJson.is_object())
+    return std::unexpected("Failed to parse shard manifest");
+  if (manifestJson.value("version", uint32_t{0}) != ManifestVersion)
+    return std::unexpected("Unsupported shard manifest version");
+  if (!manifestJson.contains("shards") || !manifestJson["shards"].is_object()) return manifest;
+
+  for (const auto &[headerPath, entryJson] : manifestJson["shards"].items()) {
+    if (!entryJson.is_object() || !entryJson.contains("file") || !entryJson["file"].is_string()) continue;
+    ShardEntry entry;
+    entry.file = entryJson["file"].get<std::string>();
+    entry.digest = entryJson.value("digest", uint64_t{0});
+    entry.objectCount = entryJson.value("objects", size_t{0});
+    manifest[headerPath] = entry;
+  }
+  return manifest;
+}
+
+auto ShardedStore::saveManifest(const fs::path &storeDir, const std::map<std::string, ShardEntry> &manifest)
+    -> std::expected<void, std::string> {
+  json::json shardsJson = json::json::object();
+  for (const auto &[headerPath, entry] : manifest)
+    shardsJson[headerPath] = {{"file", entry.file}, {"digest", entry.digest}, {"objects", entry.objectCount}};
+  json::json manifestJson = {{"version", ManifestVersion}, {"shards", shardsJson}};
+  return AtomicFile::write(storeDir / ManifestName,
+                           manifestJson.dump(4, ' ', false, json::json::error_handler_t::replace));
+}
+
+auto ShardedStore::lock(const fs::path &storeDir, bool exclusive) -> std::expected<FileLock, std::string> {
+  if (exclusive) {
+    std::error_code ec;
+    fs::create_directories(storeDir, ec);
+    if (ec) return std::unexpected("Failed to create shard directory: " + ec.message());
+  }
+  return FileLock::acquire(storeDir / LockName, exclusive);
+}
+
+auto ShardedStore::save(const fs::path &storeDir, const std::vector<Object> &objects)
+    -> std::expected<size_t, std::string> {
+  std::error_code ec;
+  auto previousResult = loadManifest(storeDir);
+  if (!previousResult) spdlog::warn("Ignoring shard manifest of {}: {}", storeDir.string(), previousResult.error());
+  std::map<std::string, ShardEntry> previous = previousResult ? std::move(previousResult.value())
+                                                              : std::map<std::string, ShardEntry>{};
+
+  std::map<std::string, std::vector<const Object *>> objectsByHeader;
+  for (const auto &obj : objects)
+    if (obj.getState() != ObjectState::Removed) objectsByHeader[std::string(obj.getObjectPathView())].push_back(&obj);
+
+  std::map<std::string, ShardEntry> manifest;
+  size_t written = 0;
+  for (const auto &[headerPath, headerObjects] : objectsByHeader) {
+    std::string data = ObjectStore::serialize(headerObjects);
+    ShardEntry entry{getShardFileName(headerPath), hashBytes(data), headerObjects.size()};
+
+    auto it = previous.find(headerPath);
+    bool unchanged = it != previous.end() && it->second.file == entry.file && it->second.digest == entry.digest &&
+                     fs::exists(storeDir / entry.file);
+    if (!unchanged) {
+      auto writeResult = AtomicFile::write(storeDir / entry.file, data);
+      if (!writeResult) return std::unexpected("Failed to write shard of " + headerPath + ": " + writeResult.error());
+      ++written;
+    }
+    manifest[headerPath] = std::move(entry);
+  }
+
+  bool manifestChanged = manifest.size() != previous.size() || !fs::exists(storeDir / ManifestName);
+  for (const auto &[headerPath, entry] : previous) {
+    auto it = manifest.find(headerPath);
+    if (it != manifest.end() && it->second.file == entry.file && it->second.digest == entry.digest) continue;
+    manifestChanged = true;
+    if (it == manifest.end()) fs::remove(storeDir / entry.file, ec);
+  }
+  if (!manifestChanged) return written;
+
+  auto manifestResult = saveManifest(storeDir, manifest);
+  if (!manifestResult) return std::unexpected(manifestResult.error());
+  return written;
+}
+
+auto ShardedStore::load(const fs::path &storeDir, std::vector<std::string> &failedHeaders)
+    -> std::expected<std::vector<Object>, std::string> {
+  if (!fs::exists(storeDir / ManifestName)) return std::vector<Object>{};
+  auto lockResult = lock(storeDir, false);
+  if (!lockResult) return std::unexpected(lockResult.error());
+  auto manifestResult = loadManifest(storeDir);
+  if (!manifestResult) return std::unexpected(manifestResult.error());
+  std::vector<const std::pair<const std::string, ShardEntry> *> shards;
+  for (const auto &shard : manifestResult.value()) shards.push_back(&shard);
+
+  std::vector<std::expected<std::vector<Object>, std::string>> results(shards.size());
+  std::atomic<size_t> nextShard = 0;
+  auto worker = [&]() {
+    AllocationScope allocationScope(Subsystem::Store);
+    for (size_t i = nextShard++; i < shards.size(); i = nextShard++)
+      results[i] = loadShard(storeDir, shards[i]->second);
+  };
+  {
+    size_t jobs = std::max<size_t>(1, std::thread::hardware_concurrency());
+    std::vector<std::jthread> workers;
+    for (size_t i = 1; i < std::min(jobs, shards.size()); ++i) workers.emplace_back(worker);
+    worker();
+  }
+
+  size_t objectCount = 0;
+  for (const auto &result : results)
+    if (result) objectCount += result->size();
+  std::vector<Object> objects;
+  objects.reserve(objectCount);
+  for (size_t i = 0; i < shards.size(); ++i) {
+    if (!results[i]) {
+      spdlog::warn("Failed to load shard of {}: {}", shards[i]->first, results[i].error());
+      failedHeaders.push_back(shards[i]->first);
+      continue;
+    }
+    for (auto &obj : results[i].value()) objects.push_back(std::move(obj));
+  }
+  return objects;
+}
+
+auto ShardedStore::loadHeader(const fs::path &storeDir, const std::string &headerPath)
+    -> std::expected<std::vector<Object>, std::string> {
+  if (!fs::exists(storeDir / ManifestName)) return std::vector<Object>{};
+  auto lockResult = lock(storeDir, false);
+  if (!lockResult) return std::unexpected(lockResult.error());
+  auto manifestResult = loadManifest(storeDir);
+  if (!manifestResult) return std::unexpected(manifestResult.error());
+  auto it = manifestResult->find(headerPath);
+  if (it == manifestResult->end()) return std::vector<Object>{};
+  return loadShard(storeDir, it->second);
+}
@@ -0,0 +1,127 @@
+#ifndef SHARDEDSTORE_HPP_
+#define SHARDEDSTORE_HPP_
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FileLock.hpp"
+#include "ObjectStore.hpp"
+#include "ObjectsManager/Object.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Entry of the shard manifest, one per source header holding objects
+ *
+ * @struct ShardEntry
+ */
+struct ShardEntry {
+  std::string file;
+  uint64_t digest = 0;
+  size_t objectCount = 0;
+};
+
+/**
+ * @brief Object cache split in one binary record per source header plus a manifest, so a save only rewrites the
+ * shards whose objects changed and a load reads the shards in parallel
+ *
+ * Each shard uses the ObjectStore layout and is named after a hash of the header path. The manifest maps header
+ * paths to their shard and the digest of its content. Every file is replaced through a rename, readers never see a
+ * partially written shard. Saves are serialized by an exclusive lock on the store, held by the caller from reading the
+ * manifest until the config pointing to it is written, the last save wins. A load holds a shared one
+ *
+ * @class ShardedStore
+ */
+class ShardedStore {
+ public:
+  /**
+   * @brief Name of the manifest inside the store directory
+   */
+  static constexpr std::string_view ManifestName = "manifest.json";
+
+  /**
+   * @brief Name of the lock file inside the store directory
+   */
+  static constexpr std::string_view LockName = "store.lock";
+
+  /**
+   * @brief Creates the store directory if needed and waits for its lock
+   *
+   * @arg storeDir
+   * @arg exclusive true for a save, false for a load
+   *
+   * @return std::expected<FileLock, std::string>
+   */
+  static auto lock(const fs::path &storeDir, bool exclusive) -> std::expected<FileLock, std::string>;
+
+  /**
+   * @brief Writes the shards of every header whose objects changed, drops the shards of headers left without objects.
+   * The caller holds the exclusive lock of the store
+   *
+   * @arg storeDir
+   * @arg objects
+   *
+   * @return std::expected<size_t, std::string> number of shards written
+   */
+  static auto save(const fs::path &storeDir, const std::vector<Object> &objects) -> std::expected<size_t, std::string>;
+
+  /**
+   * @brief Loads every shard listed in the manifest, in parallel
+   *
+   * @arg storeDir
+   * @arg failedHeaders receives the headers whose shard is missing or corrupted, their objects are not returned
+   *
+   * @return std::expected<std::vector<Object>, std::string>
+   */
+  static auto load(const fs::path &storeDir, std::vector<std::string> &failedHeaders)
+      -> std::expected<std::vector<Object>, std::string>;
+
+  /**
+   * @brief Loads the shard of a single header, the other shards are not read
+   *
+   * @arg storeDir
+   * @arg headerPath
+   *
+   * @return std::expected<std::vector<Object>, std::string> no object when the header has no shard
+   */
+  static auto loadHeader(const fs::path &storeDir, const std::string &headerPath)
+      -> std::expected<std::vector<Object>, std::string>;
+
+  /**
+   * @brief Gets the shard file name of a header, derived from a hash of its path
+   *
+   * @arg headerPath
+   *
+   * @return std::string
+   */
+  static auto getShardFileName(const std::string &headerPath) -> std::string;
+
+ private:
+  /**
+   * @brief Reads the manifest of a store directory, an absent manifest is an empty store
+   *
+   * @arg storeDir
+   *
+   * @return std::expected<std::map<std::string, ShardEntry>, std::string>
+   */
+  static auto loadManifest(const fs::path &storeDir) -> std::expected<std::map<std::string, ShardEntry>, std::string>;
+
+  /**
+   * @brief Writes the manifest of a store directory
+   *
+   * @arg storeDir
+   * @arg manifest
+   *
+   * @return std::expected<void, std::string>
+   */
+  static auto saveManifest(const fs::path &storeDir, const std::map<std::string, ShardEntry> &manifest)
+      -> std::expected<void, std::string>;
+
+  static constexpr uint32_t ManifestVersion = 1;
+};
+
+#endif /* !SHARDEDSTORE_HPP_ */
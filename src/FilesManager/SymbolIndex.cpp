@@ -0,0 +1,346 @@
+#include "SymbolIndex.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <regex>
+#include <unordered_map>
+
+#include "AtomicFile.hpp"
+#include "MappedFile.hpp"
+#include "ObjectsManager/StringPool.hpp"
+#include "Profiler/AllocationTracker.hpp"
+
+static auto appendU32(std::string &out, uint32_t value) -> void {
+  char bytes[4] = {static_cast<char>(value & 0xff), static_cast<char>((value >> 8) & 0xff),
+                   static_cast<char>((value >> 16) & 0xff), static_cast<char>((value >> 24) & 0xff)};
+  out.append(bytes, sizeof(bytes));
+}
+
+static auto appendU64(std::string &out, uint64_t value) -> void {
+  appendU32(out, static_cast<uint32_t>(value & 0xffffffff));
+  appendU32(out, static_cast<uint32_t>(value >> 32));
+}
+
+static auto appendString(std::string &out, std::string_view str) -> void {
+  appendU32(out, static_cast<uint32_t>(str.size()));
+  out.append(str);
+}
+
+/**
+ * @brief Packs the three characters starting at a position in a trigram key
+ *
+ * @arg str
+ * @arg pos
+ *
+ * @return uint32_t
+ */
+static auto getTrigram(std::string_view str, size_t pos) -> uint32_t {
+  return static_cast<uint32_t>(static_cast<unsigned char>(str[pos])) << 16 |
+         static_cast<uint32_t>(static_cast<unsigned char>(str[pos + 1])) << 8 |
+         static_cast<uint32_t>(static_cast<unsigned char>(str[pos + 2]));
+}
+
+/**
+ * @brief Gets the distinct trigrams of a string, sorted
+ *
+ * @arg str
+ * @arg trigrams receives the trigrams, cleared first
+ *
+ * @return void
+ */
+static auto getTrigrams(std::string_view str, std::vector<uint32_t> &trigrams) -> void {
+  trigrams.clear();
+  for (size_t pos = 0; pos + 3 <= str.size(); ++pos) trigrams.push_back(getTrigram(str, pos));
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+/**
+ * @brief Bounds-checked reader over the binary layout
+ *
+ * @struct IndexReader
+ */
+struct IndexReader {
+  std::string_view data;
+  size_t pos = 0;
+  bool failed = false;
+
+  auto readU32() -> uint32_t {
+    if (failed || data.size() - pos < 4) {
+      failed = true;
+      return 0;
+    }
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data.data() + pos);
+    pos += 4;
+    return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+           static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+  }
+
+  auto readU64() -> uint64_t {
+    uint64_t low = readU32();
+    return low | static_cast<uint64_t>(readU32()) << 32;
+  }
+
+  auto readBytes(size_t length) -> std::string_view {
+    if (failed || data.size() - pos < length) {
+      failed = true;
+      return {};
+    }
+    std::string_view bytes = data.substr(pos, length);
+    pos += length;
+    return bytes;
+  }
+
+  /**
+   * @brief Reads a list of ascending indexes below a bound
+   */
+  auto readIndexes(uint32_t bound, std::vector<uint32_t> &out) -> void {
+    uint32_t count = readU32();
+    if (failed || count > (data.size() - pos) / 4) {
+      failed = true;
+      return;
+    }
+    size_t first = out.size();
+    for (uint32_t i = 0; i < count; ++i) {
+      uint32_t index = readU32();
+      if (index >= bound || (out.size() > first && index <= out.back())) failed = true;
+      out.push_back(index);
+    }
+  }
+};
+
+auto SymbolIndex::build(const std::vector<Object> &objects, const std::vector<ObjectSpan> &spans) -> SymbolIndex {
+  AllocationScope allocationScope(Subsystem::Index);
+  SymbolIndex index;
+  std::unordered_map<std::string_view, std::vector<uint32_t>> filesByName;
+  std::vector<std::vector<ObjectSpan>> spansByFile;
+  for (size_t i = 0; i < objects.size(); ++i) {
+    const Object &obj = objects[i];
+    if (obj.getState() == ObjectState::Removed || obj.getObjectName().empty()) continue;
+    auto [file, inserted] =
+        index.fileIndexes_.emplace(obj.getObjectPathView(), static_cast<uint32_t>(index.files_.size()));
+    if (inserted) {
+      index.files_.push_back(obj.getObjectPathView());
+      spansByFile.emplace_back();
+    }
+    std::vector<uint32_t> &nameFiles = filesByName[obj.getObjectName()];
+    if (nameFiles.empty() || nameFiles.back() != file->second) nameFiles.push_back(file->second);
+    if (i < spans.size()) spansByFile[file->second].push_back(spans[i]);
+  }
+  index.fileSpanOffsets_.reserve(index.files_.size() + 1);
+  index.fileSpanOffsets_.push_back(0);
+  for (const auto &fileSpans : spansByFile) {
+    index.spans_.insert(index.spans_.end(), fileSpans.begin(), fileSpans.end());
+    index.fileSpanOffsets_.push_back(static_cast<uint32_t>(index.spans_.size()));
+  }
+
+  index.names_.reserve(filesByName.size());
+  for (const auto &[name, nameFiles] : filesByName) index.names_.push_back(name);
+  std::sort(index.names_.begin(), index.names_.end());
+
+  std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+  std::vector<uint32_t> trigrams;
+  index.nameFileOffsets_.reserve(index.names_.size() + 1);
+  index.nameFileOffsets_.push_back(0);
+  for (size_t i = 0; i < index.names_.size(); ++i) {
+    std::vector<uint32_t> &nameFiles = filesByName[index.names_[i]];
+    std::sort(nameFiles.begin(), nameFiles.end());
+    nameFiles.erase(std::unique(nameFiles.begin(), nameFiles.end()), nameFiles.end());
+    index.nameFiles_.insert(index.nameFiles_.end(), nameFiles.begin(), nameFiles.end());
+    index.nameFileOffsets_.push_back(static_cast<uint32_t>(index.nameFiles_.size()));
+    // names are visited in order, every posting list comes out sorted
+    getTrigrams(index.names_[i], trigrams);
+    for (uint32_t trigram : trigrams) postings[trigram].push_back(static_cast<uint32_t>(i));
+  }
+
+  index.trigramKeys_.reserve(postings.size());
+  for (const auto &[trigram, names] : postings) index.trigramKeys_.push_back(trigram);
+  std::sort(index.trigramKeys_.begin(), index.trigramKeys_.end());
+  index.trigramOffsets_.reserve(index.trigramKeys_.size() + 1);
+  index.trigramOffsets_.push_back(0);
+  for (uint32_t trigram : index.trigramKeys_) {
+    const std::vector<uint32_t> &names = postings[trigram];
+    index.trigramPostings_.insert(index.trigramPostings_.end(), names.begin(), names.end());
+    index.trigramOffsets_.push_back(static_cast<uint32_t>(index.trigramPostings_.size()));
+  }
+  return index;
+}
+
+auto SymbolIndex::serialize(uint64_t saveId) const -> std::string {
+  std::string out(Magic);
+  appendU32(out, Version);
+  appendU64(out, saveId);
+  appendU32(out, static_cast<uint32_t>(files_.size()));
+  for (std::string_view file : files_) appendString(out, file);
+  appendU32(out, static_cast<uint32_t>(names_.size()));
+  for (size_t i = 0; i < names_.size(); ++i) {
+    appendString(out, names_[i]);
+    appendU32(out, nameFileOffsets_[i + 1] - nameFileOffsets_[i]);
+    for (uint32_t j = nameFileOffsets_[i]; j < nameFileOffsets_[i + 1]; ++j) appendU32(out, nameFiles_[j]);
+  }
+  appendU32(out, static_cast<uint32_t>(trigramKeys_.size()));
+  for (size_t i = 0; i < trigramKeys_.size(); ++i) {
+    appendU32(out, trigramKeys_[i]);
+    appendU32(out, trigramOffsets_[i + 1] - trigramOffsets_[i]);
+    for (uint32_t j = trigramOffsets_[i]; j < trigramOffsets_[i + 1]; ++j) appendU32(out, trigramPostings_[j]);
+  }
+  for (size_t i = 0; i < files_.size(); ++i) {
+    appendU32(out, fileSpanOffsets_[i + 1] - fileSpanOffsets_[i]);
+    for (uint32_t j = fileSpanOffsets_[i]; j < fileSpanOffsets_[i + 1]; ++j) {
+      appendU64(out, spans_[j].offset);
+      appendU32(out, spans_[j].length);
+    }
+  }
+  return out;
+}
+
+auto SymbolIndex::deserialize(std::string_view data, uint64_t saveId) -> std::expected<SymbolIndex, std::string> {
+  IndexReader reader{data};
+  if (reader.readBytes(Magic.size()) != Magic) return std::unexpected("Not a Toxidoc symbol index");
+  if (reader.readU32() != Version) return std::unexpected("Unsupported symbol index version");
+  if (reader.readU64() != saveId) return std::unexpected("Symbol index does not match the saved objects");
+
+  StringPool &pool = StringPool::global();
+  SymbolIndex index;
+  uint32_t fileCount = reader.readU32();
+  index.files_.reserve(std::min<size_t>(fileCount, data.size() / 4));
+  for (uint32_t i = 0; i < fileCount && !reader.failed; ++i) {
+    index.files_.push_back(pool.intern(reader.readBytes(reader.readU32())));
+    index.fileIndexes_.emplace(index.files_.back(), i);
+  }
+
+  uint32_t nameCount = reader.readU32();
+  index.names_.reserve(std::min<size_t>(nameCount, data.size() / 4));
+  index.nameFileOffsets_.push_back(0);
+  for (uint32_t i = 0; i < nameCount && !reader.failed; ++i) {
+    index.names_.push_back(pool.intern(reader.readBytes(reader.readU32())));
+    // prefix queries rely on the order
+    if (i > 0 && index.names_[i - 1] >= index.names_[i]) reader.failed = true;
+    reader.readIndexes(fileCount, index.nameFiles_);
+    index.nameFileOffsets_.push_back(static_cast<uint32_t>(index.nameFiles_.size()));
+  }
+
+  uint32_t trigramCount = reader.readU32();
+  index.trigramOffsets_.push_back(0);
+  for (uint32_t i = 0; i < trigramCount && !reader.failed; ++i) {
+    index.trigramKeys_.push_back(reader.readU32());
+    if (i > 0 && index.trigramKeys_[i - 1] >= index.trigramKeys_[i]) reader.failed = true;
+    reader.readIndexes(nameCount, index.trigramPostings_);
+    index.trigramOffsets_.push_back(static_cast<uint32_t>(index.trigramPostings_.size()));
+  }
+
+  // checked against the store when they are read
+  index.fileSpanOffsets_.push_back(0);
+  for (uint32_t i = 0; i < fileCount && !reader.failed; ++i) {
+    uint32_t spanCount = reader.readU32();
+    if (spanCount > (data.size() - reader.pos) / 12) reader.failed = true;
+    for (uint32_t j = 0; j < spanCount && !reader.failed; ++j) {
+      uint64_t offset = reader.readU64();
+      index.spans_.push_back({offset, reader.readU32()});
+    }
+    index.fileSpanOffsets_.push_back(static_cast<uint32_t>(index.spans_.size()));
+  }
+  if (reader.failed) return std::unexpected("Truncated or corrupted symbol index");
+  return index;
+}
+
+auto SymbolIndex::save(const fs::path &indexPath, uint64_t saveId) const -> std::expected<void, std::string> {
+  return AtomicFile::write(indexPath, serialize(saveId));
+}
+
+auto SymbolIndex::load(const fs::path &indexPath, uint64_t saveId) -> std::expected<SymbolIndex, std::string> {
+  AllocationScope allocationScope(Subsystem::Index);
+  auto mapResult = MappedFile::open(indexPath);
+  if (!mapResult) return std::unexpected(mapResult.error());
+  return deserialize(mapResult->view(), saveId);
+}
+
+auto SymbolIndex::getMatchFromString(const std::string &matchStr) -> std::optional<SymbolMatch> {
+  for (const auto &[match, name] : SymbolMatchStringMap)
+    if (name == matchStr) return match;
+  return std::nullopt;
+}
+
+auto SymbolIndex::find(std::string_view pattern, SymbolMatch match) const
+    -> std::expected<std::vector<size_t>, std::string> {
+  std::vector<size_t> found;
+  switch (match) {
+    case SymbolMatch::Prefix: {
+      auto first = std::lower_bound(names_.begin(), names_.end(), pattern);
+      for (auto it = first; it != names_.end() && it->starts_with(pattern); ++it) found.push_back(it - names_.begin());
+      break;
+    }
+    case SymbolMatch::Substring: {
+      if (pattern.size() >= 3) return findSubstring(pattern);
+      // too short to hold a trigram, the distinct names are few next to the objects
+      for (size_t i = 0; i < names_.size(); ++i)
+        if (names_[i].contains(pattern)) found.push_back(i);
+      break;
+    }
+    case SymbolMatch::Regex: {
+      std::regex regex;
+      try {
+        regex.assign(pattern.begin(), pattern.end());
+      } catch (const std::regex_error &e) {
+        return std::unexpected(std::string("Invalid regex: ") + e.what());
+      }
+      for (size_t i = 0; i < names_.size(); ++i)
+        if (std::regex_search(names_[i].begin(), names_[i].end(), regex)) found.push_back(i);
+      break;
+    }
+  }
+  return found;
+}
+
+auto SymbolIndex::findSubstring(std::string_view pattern) const -> std::vector<size_t> {
+  std::vector<uint32_t> trigrams;
+  getTrigrams(pattern, trigrams);
+  std::vector<std::pair<const uint32_t *, const uint32_t *>> lists;
+  for (uint32_t trigram : trigrams) {
+    auto postings = getPostings(trigram);
+    if (postings.first == postings.second) return {};
+    lists.push_back(postings);
+  }
+  // shortest lists first, the candidates shrink as fast as possible
+  std::sort(lists.begin(), lists.end(),
+            [](const auto &a, const auto &b) { return a.second - a.first < b.second - b.first; });
+
+  std::vector<uint32_t> candidates(lists.front().first, lists.front().second);
+  std::vector<uint32_t> kept;
+  for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+    kept.clear();
+    std::set_intersection(candidates.begin(), candidates.end(), lists[i].first, lists[i].second,
+                          std::back_inserter(kept));
+    candidates.swap(kept);
+  }
+
+  // sharing every trigram does not make the pattern a substring, abd and bdc are in abdxbdc
+  std::vector<size_t> found;
+  for (uint32_t candidate : candidates)
+    if (names_[candidate].contains(pattern)) found.push_back(candidate);
+  return found;
+}
+
+auto SymbolIndex::getPostings(uint32_t trigram) const -> std::pair<const uint32_t *, const uint32_t *> {
+  auto it = std::lower_bound(trigramKeys_.begin(), trigramKeys_.end(), trigram);
+  if (it == trigramKeys_.end() || *it != trigram) return {nullptr, nullptr};
+  size_t key = it - trigramKeys_.begin();
+  return {trigramPostings_.data() + trigramOffsets_[key], trigramPostings_.data() + trigramOffsets_[key + 1]};
+}
+
+auto SymbolIndex::getName(size_t nameIndex) const -> std::string_view { return names_[nameIndex]; }
+
+auto SymbolIndex::getNameFiles(size_t nameIndex) const -> std::vector<std::string_view> {
+  std::vector<std::string_view> nameFiles;
+  for (uint32_t i = nameFileOffsets_[nameIndex]; i < nameFileOffsets_[nameIndex + 1]; ++i)
+    nameFiles.push_back(files_[nameFiles_[i]]);
+  return nameFiles;
+}
+
+auto SymbolIndex::getFileSpans(std::string_view file) const -> std::vector<ObjectSpan> {
+  auto it = fileIndexes_.find(file);
+  if (it == fileIndexes_.end()) return {};
+  return {spans_.begin() + fileSpanOffsets_[it->second], spans_.begin() + fileSpanOffsets_[it->second + 1]};
+}
+
+auto SymbolIndex::getNamesCount() const -> size_t { return names_.size(); }
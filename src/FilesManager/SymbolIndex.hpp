@@ -0,0 +1,194 @@
+#ifndef SYMBOLINDEX_HPP_
+#define SYMBOLINDEX_HPP_
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ObjectStore.hpp"
+#include "ObjectsManager/Object.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Ways a name can be matched against a query
+ *
+ * @enum SymbolMatch
+ */
+enum class SymbolMatch {
+  Prefix,
+  Substring,
+  Regex,
+};
+
+const std::map<SymbolMatch, std::string> SymbolMatchStringMap = {
+    {SymbolMatch::Prefix, "prefix"},
+    {SymbolMatch::Substring, "substring"},
+    {SymbolMatch::Regex, "regex"},
+};
+
+/**
+ * @brief Name index of the saved objects, answers lookups without walking the objects or parsing a header
+ *
+ * Distinct names are kept sorted, each one with the files declaring it. Prefix queries are a binary search, substring
+ * queries intersect the trigram posting lists of the query before checking the few candidates left, regex queries
+ * scan the distinct names only. Names and files are interned, they compare with the objects by address. Each file
+ * also keeps where its objects are stored, so a lookup loads the objects of the matched files only.
+ *
+ * Layout: "TXIX" magic, u32 version, u64 save id, u32 file count then each file as u32 length + bytes, u32 name count
+ * then each name as u32 length + bytes + u32 file count + file indexes, u32 trigram count then each trigram as u32
+ * key + u32 name count + name indexes, then for each file a u32 span count + spans as u64 offset + u32 length.
+ * Integers are little-endian
+ *
+ * @class SymbolIndex
+ */
+class SymbolIndex {
+ public:
+  /**
+   * @brief Indexes the names of objects, objects in the Removed state are skipped
+   *
+   * @arg objects
+   * @arg spans optional, where each object is stored, empty when the objects are not stored in a single file
+   *
+   * @return SymbolIndex
+   */
+  static auto build(const std::vector<Object> &objects, const std::vector<ObjectSpan> &spans = {}) -> SymbolIndex;
+
+  /**
+   * @brief Writes the index through a temporary file renamed over the target
+   *
+   * @arg indexPath
+   * @arg saveId identifier of the save the indexed objects come from, to be checked by load
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto save(const fs::path &indexPath, uint64_t saveId) const -> std::expected<void, std::string>;
+
+  /**
+   * @brief Loads an index written by save
+   *
+   * @arg indexPath
+   * @arg saveId identifier given to save, an index replaced or left behind by another save is rejected
+   *
+   * @return std::expected<SymbolIndex, std::string>
+   */
+  static auto load(const fs::path &indexPath, uint64_t saveId) -> std::expected<SymbolIndex, std::string>;
+
+  /**
+   * @brief Gets the SymbolMatch from its string representation
+   *
+   * @arg matchStr
+   *
+   * @return std::optional<SymbolMatch>
+   */
+  static auto getMatchFromString(const std::string &matchStr) -> std::optional<SymbolMatch>;
+
+  /**
+   * @brief Finds the names matching a query
+   *
+   * @arg pattern
+   * @arg match
+   *
+   * @return std::expected<std::vector<size_t>, std::string> sorted indexes of the matching names, an error for an
+   * invalid regex
+   */
+  auto find(std::string_view pattern, SymbolMatch match) const -> std::expected<std::vector<size_t>, std::string>;
+
+  /**
+   * @brief Gets an indexed name
+   *
+   * @arg nameIndex
+   *
+   * @return std::string_view interned name
+   */
+  auto getName(size_t nameIndex) const -> std::string_view;
+
+  /**
+   * @brief Gets the files declaring an indexed name
+   *
+   * @arg nameIndex
+   *
+   * @return std::vector<std::string_view> interned file paths
+   */
+  auto getNameFiles(size_t nameIndex) const -> std::vector<std::string_view>;
+
+  /**
+   * @brief Gets where the indexed objects of a file are stored
+   *
+   * @arg file
+   *
+   * @return std::vector<ObjectSpan> in the order of the objects, empty for an unknown file or an index built without
+   * spans
+   */
+  auto getFileSpans(std::string_view file) const -> std::vector<ObjectSpan>;
+
+  /**
+   * @brief Gets the number of distinct names
+   *
+   * @return size_t
+   */
+  auto getNamesCount() const -> size_t;
+
+ private:
+  /**
+   * @brief Serializes the index to the binary layout
+   *
+   * @arg saveId
+   *
+   * @return std::string
+   */
+  auto serialize(uint64_t saveId) const -> std::string;
+
+  /**
+   * @brief Parses an index from the binary layout
+   *
+   * @arg data
+   * @arg saveId expected save identifier
+   *
+   * @return std::expected<SymbolIndex, std::string>
+   */
+  static auto deserialize(std::string_view data, uint64_t saveId) -> std::expected<SymbolIndex, std::string>;
+
+  /**
+   * @brief Finds the names containing a pattern of at least three characters through the trigram posting lists
+   *
+   * @arg pattern
+   *
+   * @return std::vector<size_t>
+   */
+  auto findSubstring(std::string_view pattern) const -> std::vector<size_t>;
+
+  /**
+   * @brief Gets the names holding a trigram
+   *
+   * @arg trigram
+   *
+   * @return std::pair<const uint32_t *, const uint32_t *> bounds of the posting list, empty when the trigram is unknown
+   */
+  auto getPostings(uint32_t trigram) const -> std::pair<const uint32_t *, const uint32_t *>;
+
+  static constexpr std::string_view Magic = "TXIX";
+  static constexpr uint32_t Version = 2;
+
+  std::vector<std::string_view> files_;
+  std::unordered_map<std::string_view, uint32_t> fileIndexes_;
+  // objects of file i are stored at spans_[fileSpanOffsets_[i], fileSpanOffsets_[i + 1])
+  std::vector<uint32_t> fileSpanOffsets_;
+  std::vector<ObjectSpan> spans_;
+  std::vector<std::string_view> names_;
+  // files of name i are nameFiles_[nameFileOffsets_[i], nameFileOffsets_[i + 1])
+  std::vector<uint32_t> nameFileOffsets_;
+  std::vector<uint32_t> nameFiles_;
+  // sorted keys, the names holding trigramKeys_[i] are trigramPostings_[trigramOffsets_[i], trigramOffsets_[i + 1])
+  std::vector<uint32_t> trigramKeys_;
+  std::vector<uint32_t> trigramOffsets_;
+  std::vector<uint32_t> trigramPostings_;
+};
+
+#endif /* !SYMBOLINDEX_HPP_ */
@@ -0,0 +1,60 @@
+#ifndef COUNTINGRESOURCE_HPP_
+#define COUNTINGRESOURCE_HPP_
+
+#include <cstddef>
+#include <memory_resource>
+
+/**
+ * @brief Memory resource forwarding to another one while counting the allocations going through it
+ *
+ * Not thread-safe, meant for resources owned by a single translation unit walk
+ *
+ * @class CountingResource
+ */
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  /**
+   * @brief Constructs a CountingResource serving allocations from the heap
+   */
+  CountingResource() : upstream_(std::pmr::new_delete_resource()) {}
+
+  /**
+   * @brief Constructs a CountingResource
+   *
+   * @arg upstream resource serving the allocations
+   */
+  explicit CountingResource(std::pmr::memory_resource *upstream) : upstream_(upstream) {}
+
+  /**
+   * @brief Gets the number of allocations served
+   *
+   * @return size_t
+   */
+  auto getAllocationsCount() const -> size_t { return allocations_; }
+
+  /**
+   * @brief Gets the number of bytes allocated
+   *
+   * @return size_t
+   */
+  auto getAllocatedBytes() const -> size_t { return bytes_; }
+
+ private:
+  auto do_allocate(size_t bytes, size_t alignment) -> void * override {
+    allocations_++;
+    bytes_ += bytes;
+    return upstream_->allocate(bytes, alignment);
+  }
+
+  auto do_deallocate(void *p, size_t bytes, size_t alignment) -> void override {
+    upstream_->deallocate(p, bytes, alignment);
+  }
+
+  auto do_is_equal(const std::pmr::memory_resource &other) const noexcept -> bool override { return this == &other; }
+
+  std::pmr::memory_resource *upstream_;
+  size_t allocations_ = 0;
+  size_t bytes_ = 0;
+};
+
+#endif /* !COUNTINGRESOURCE_HPP_ */
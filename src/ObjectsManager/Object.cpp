@@ -1,53 +1,99 @@
 #include "Object.hpp"
 
-Object::Object(const fs::path &filePath, const std::string &objName, ObjectType type, size_t startLine,
-               size_t startColumn, size_t endLine, size_t endColumn, const std::string &rawComment,
-               const std::string &debrief, const std::vector<std::string> &arguments, const std::string &returnType,
-               ObjectState state = ObjectState::Unchanged)
-    : filePath_(filePath),
-      name_(objName),
-      type_(type),
+/**
+ * @brief Compares two interned strings, equal content means same address
+ *
+ * @arg lhs
+ * @arg rhs
+ *
+ * @return bool
+ */
+static auto isSameString(std::string_view lhs, std::string_view rhs) -> bool {
+  return lhs.data() == rhs.data() && lhs.size() == rhs.size();
+}
+
+Object::Object()
+    : arguments_(StringPool::emptyList()),
+      overloadIndex_(0),
+      startLine_(0),
+      startColumn_(0),
+      endLine_(0),
+      endColumn_(0),
+      type_(ObjectType::Unknown),
+      state_(ObjectState::Unchanged) {}
+
+Object::Object(std::string_view filePath, std::string_view objName, std::string_view scope, ObjectType type,
+               uint32_t startLine, uint32_t startColumn, uint32_t endLine, uint32_t endColumn,
+               std::string_view rawComment, std::string_view debrief, std::span<const std::string_view> arguments,
+               std::string_view returnType, ObjectState state = ObjectState::Unchanged)
+    : arguments_(StringPool::emptyList()),
+      overloadIndex_(0),
       startLine_(startLine),
       startColumn_(startColumn),
       endLine_(endLine),
       endColumn_(endColumn),
-      rawComment_(rawComment),
-      debrief_(debrief),
-      arguments_(arguments),
-      returnType_(returnType),
-      state_(state) {}
-
-Object::Object(const json::json &j) {
-  if (j.contains("file_path") && j["file_path"].is_string()) filePath_ = fs::path(j["file_path"].get<std::string>());
-  if (j.contains("name") && j["name"].is_string()) name_ = j["name"].get<std::string>();
-  if (j.contains("type") && j["type"].is_string()) type_ = getObjectTypeFromString(j["type"].get<std::string>());
-  if (j.contains("overload_index") && j["overload_index"].is_number_unsigned())
-    overloadIndex_ = j["overload_index"].get<size_t>();
-  if (j.contains("start_line") && j["start_line"].is_number_unsigned()) startLine_ = j["start_line"].get<size_t>();
-  if (j.contains("start_column") && j["start_column"].is_number_unsigned())
-    startColumn_ = j["start_column"].get<size_t>();
-  if (j.contains("end_line") && j["end_line"].is_number_unsigned()) endLine_ = j["end_line"].get<size_t>();
-  if (j.contains("end_column") && j["end_column"].is_number_unsigned()) endColumn_ = j["end_column"].get<size_t>();
-  if (j.contains("raw_comment") && j["raw_comment"].is_string()) rawComment_ = j["raw_comment"].get<std::string>();
-  if (j.contains("debrief") && j["debrief"].is_string()) debrief_ = j["debrief"].get<std::string>();
-  if (j.contains("arguments") && j["arguments"].is_array()) {
-    arguments_.clear();
-    for (const auto &arg : j["arguments"])
-      if (arg.is_string()) arguments_.push_back(arg.get<std::string>());
+      type_(type),
+      state_(state) {
+  StringPool &pool = StringPool::global();
+  filePath_ = pool.intern(filePath);
+  name_ = pool.intern(objName);
+  scope_ = pool.intern(scope);
+  rawComment_ = pool.intern(rawComment);
+  debrief_ = pool.intern(debrief);
+  returnType_ = pool.intern(returnType);
+  if (!arguments.empty()) {
+    std::vector<std::string_view> internedArguments;
+    internedArguments.reserve(arguments.size());
+    for (std::string_view arg : arguments) internedArguments.push_back(pool.intern(arg));
+    arguments_ = pool.internList(internedArguments);
   }
-  if (j.contains("return_type") && j["return_type"].is_string()) returnType_ = j["return_type"].get<std::string>();
+}
+
+Object::Object(const json::json &j) : Object() {
+  StringPool &pool = StringPool::global();
+  visitFields(*this, [this, &j, &pool](std::string_view key, auto &field) {
+    auto it = j.find(key);
+    if (it == j.end()) return;
+    using Field = std::remove_cvref_t<decltype(field)>;
+    if constexpr (std::is_same_v<Field, std::string_view>) {
+      if (it->is_string()) field = pool.intern(it->get_ref<const std::string &>());
+    } else if constexpr (std::is_same_v<Field, uint32_t>) {
+      if (it->is_number_unsigned()) field = it->get<uint32_t>();
+    } else if constexpr (std::is_same_v<Field, ObjectType>) {
+      if (it->is_string()) field = getObjectTypeFromString(it->get<std::string>());
+    } else if (it->is_array()) {
+      std::vector<std::string_view> arguments;
+      for (const auto &arg : *it)
+        if (arg.is_string()) arguments.push_back(pool.intern(arg.get_ref<const std::string &>()));
+      field = pool.internList(arguments);
+    }
+  });
 }
 
 auto Object::operator==(const Object &other) const -> bool {
-  return filePath_ == other.filePath_ && name_ == other.name_ && type_ == other.type_ &&
-         overloadIndex_ == other.overloadIndex_ && returnType_ == other.returnType_;
+  return isSameString(filePath_, other.filePath_) && isSameString(name_, other.name_) &&
+         isSameString(scope_, other.scope_) && type_ == other.type_ && overloadIndex_ == other.overloadIndex_ &&
+         isSameString(returnType_, other.returnType_);
+}
+
+auto Object::getIdentityHash() const -> size_t {
+  // interned strings are hashed by address, equal strings share it
+  std::hash<const char *> hashAddress;
+  size_t hash = hashAddress(filePath_.data());
+  auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2); };
+  combine(hashAddress(name_.data()));
+  combine(hashAddress(scope_.data()));
+  combine(static_cast<size_t>(type_));
+  combine(overloadIndex_);
+  combine(hashAddress(returnType_.data()));
+  return hash;
 }
 
-auto Object::isValid() const -> bool { return debrief_.length() > 0; }
+auto Object::isValid() const -> bool { return !debrief_.empty(); }
 
 auto Object::setState(ObjectState state) -> void { state_ = state; }
 
-auto Object::setOverloadIndex(size_t index) -> void { overloadIndex_ = index; }
+auto Object::setOverloadIndex(size_t index) -> void { overloadIndex_ = static_cast<uint32_t>(index); }
 
 template <typename T>
 static T isModified(const T &a, const T &b, bool &modifiedFlag) {
@@ -60,17 +106,24 @@ static T isModified(const T &a, const T &b, bool &modifiedFlag) {
 
 auto Object::updateObject(const Object &other) -> void {
   bool modified = false;
-  filePath_ = isModified(filePath_, other.filePath_, modified);
-  name_ = isModified(name_, other.name_, modified);
+  auto updateString = [&modified](std::string_view &field, std::string_view value) {
+    if (isSameString(field, value)) return;
+    field = value;
+    modified = true;
+  };
+  updateString(filePath_, other.filePath_);
+  updateString(name_, other.name_);
+  updateString(scope_, other.scope_);
   type_ = isModified(type_, other.type_, modified);
   startLine_ = other.startLine_;
   startColumn_ = other.startColumn_;
   endLine_ = other.endLine_;
   endColumn_ = other.endColumn_;
-  rawComment_ = isModified(rawComment_, other.rawComment_, modified);
-  debrief_ = isModified(debrief_, other.debrief_, modified);
+  updateString(rawComment_, other.rawComment_);
+  updateString(debrief_, other.debrief_);
+  // interned lists are equal only when they are the same list
   arguments_ = isModified(arguments_, other.arguments_, modified);
-  returnType_ = isModified(returnType_, other.returnType_, modified);
+  updateString(returnType_, other.returnType_);
   if (modified && state_ == ObjectState::Unchanged) state_ = ObjectState::Modified;
 }
 
@@ -86,47 +139,69 @@ auto Object::getStateAsString() const -> std::string {
   }
 }
 
-auto Object::getObjectName() const -> std::string { return name_; }
+auto Object::getObjectName() const -> std::string_view { return name_; }
+
+auto Object::getObjectScope() const -> std::string_view { return scope_; }
+
+auto Object::getOverloadIndex() const -> size_t { return overloadIndex_; }
+
+auto Object::getStartLine() const -> size_t { return startLine_; }
+
+auto Object::getStartColumn() const -> size_t { return startColumn_; }
+
+auto Object::getEndLine() const -> size_t { return endLine_; }
+
+auto Object::getEndColumn() const -> size_t { return endColumn_; }
+
+auto Object::getRawComment() const -> std::string_view { return rawComment_; }
+
+auto Object::getDebrief() const -> std::string_view { return debrief_; }
+
+auto Object::getArguments() const -> const std::vector<std::string_view> & { return *arguments_; }
+
+auto Object::getReturnType() const -> std::string_view { return returnType_; }
 
 auto Object::getObjectAsString() const -> std::string {
   std::string result;
-  result +=
-      "Location: " + filePath_.string() + ":" + std::to_string(startLine_) + ":" + std::to_string(startColumn_) + "\n";
+  result += "Location: " + getObjectPathAsString() + "\n";
   result += "Type: " + getObjectTypeAsString() + "\n";
-  result += "Object Name: " + name_ + "\n";
+  result += "Object Name: " + std::string(name_) + "\n";
+  result += "Scope: " + std::string(scope_) + "\n";
   result += "Overload Index: " + std::to_string(overloadIndex_) + "\n";
-  for (size_t i = 0; i < arguments_.size(); ++i)
-    result += "Argument " + std::to_string(i) + ": " + arguments_[i] + "\n";
-  result += "Return Type: " + returnType_ + "\n";
-  result += "Raw Comment: " + rawComment_ + "\n";
-  result += "Debrief: " + debrief_ + "\n";
+  for (size_t i = 0; i < arguments_->size(); ++i)
+    result += "Argument " + std::to_string(i) + ": " + std::string((*arguments_)[i]) + "\n";
+  result += "Return Type: " + std::string(returnType_) + "\n";
+  result += "Raw Comment: " + std::string(rawComment_) + "\n";
+  result += "Debrief: " + std::string(debrief_) + "\n";
   result += "State: " + getStateAsString() + "\n";
   return result;
 }
 
 auto Object::getObjectPathAsString() const -> std::string {
-  std::string result;
-  result += filePath_.string() + ":";
-  result += std::to_string(startLine_) + ":" + std::to_string(startColumn_);
+  std::string result(filePath_);
+  result += ":" + std::to_string(startLine_) + ":" + std::to_string(startColumn_);
   return result;
 }
 
-auto Object::getObjectPath() const -> fs::path { return filePath_; }
+auto Object::getObjectPath() const -> fs::path { return fs::path(filePath_); }
+
+auto Object::getObjectPathView() const -> std::string_view { return filePath_; }
 
 auto Object::getObjectAsJSON() const -> json::json {
   json::json j;
-  j["file_path"] = filePath_.string();
-  j["name"] = name_;
-  j["type"] = getObjectTypeAsString();
-  j["overload_index"] = overloadIndex_;
-  j["start_line"] = startLine_;
-  j["start_column"] = startColumn_;
-  j["end_line"] = endLine_;
-  j["end_column"] = endColumn_;
-  j["raw_comment"] = rawComment_;
-  j["debrief"] = debrief_;
-  j["arguments"] = arguments_;
-  j["return_type"] = returnType_;
+  visitFields(*this, [this, &j](std::string_view key, const auto &field) {
+    using Field = std::remove_cvref_t<decltype(field)>;
+    if constexpr (std::is_same_v<Field, std::string_view>) {
+      j[key] = std::string(field);
+    } else if constexpr (std::is_same_v<Field, uint32_t>) {
+      j[key] = field;
+    } else if constexpr (std::is_same_v<Field, ObjectType>) {
+      j[key] = getObjectTypeAsString();
+    } else {
+      j[key] = json::json::array();
+      for (std::string_view arg : *field) j[key].push_back(std::string(arg));
+    }
+  });
   return j;
 }
 
@@ -1,8 +1,14 @@
 #ifndef OBJECT_HPP_
 #define OBJECT_HPP_
 
+#include <cstdint>
 #include <filesystem>
 #include <nlohmann/json.hpp>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "StringPool.hpp"
 
 namespace fs = std::filesystem;
 namespace json = nlohmann;
@@ -10,7 +16,7 @@ namespace json = nlohmann;
 /**
  * @brief Type of the object
  */
-enum class ObjectType {
+enum class ObjectType : uint8_t {
   Unknown,
   Function,
   Constructor,
@@ -46,20 +52,31 @@ const std::map<ObjectType, std::string> ObjectTypeStringMap = {
 /**
  * @brief State of the object
  */
-enum class ObjectState { Unchanged, Modified, Added, Removed };
+enum class ObjectState : uint8_t { Unchanged, Modified, Added, Removed };
 
 /**
  * @brief Represents a code object extracted from source files
  *
+ * Strings and argument lists are views into the global StringPool, an object only holds handles and 32-bit positions.
+ * Copies are cheap and equal strings are compared by address
+ *
  * @class Object
  */
 class Object {
  public:
+  /**
+   * @brief Constructs an empty Object
+   *
+   * @return void
+   */
+  Object();
+
   /**
    * @brief Constructor for Object
    *
    * @arg filePath
    * @arg objName
+   * @arg scope
    * @arg type
    * @arg startLine
    * @arg startColumn
@@ -73,9 +90,10 @@ class Object {
    *
    * @return void
    */
-  Object(const fs::path &filePath, const std::string &objName, ObjectType type, size_t startLine, size_t startColumn,
-         size_t endLine, size_t endColumn, const std::string &rawComment, const std::string &debrief,
-         const std::vector<std::string> &arguments, const std::string &returnType, ObjectState state);
+  Object(std::string_view filePath, std::string_view objName, std::string_view scope, ObjectType type,
+         uint32_t startLine, uint32_t startColumn, uint32_t endLine, uint32_t endColumn, std::string_view rawComment,
+         std::string_view debrief, std::span<const std::string_view> arguments, std::string_view returnType,
+         ObjectState state);
 
   /**
    * @brief Constructor for Object from JSON
@@ -102,6 +120,13 @@ class Object {
    */
   auto operator==(const Object &other) const -> bool;
 
+  /**
+   * @brief Hash of the fields compared by operator==, objects equal by identity share the same hash
+   *
+   * @return size_t
+   */
+  auto getIdentityHash() const -> size_t;
+
   /**
    * @brief Validity check
    *
@@ -153,9 +178,79 @@ class Object {
   /**
    * @brief gets the name of the object
    *
-   * @return std::string
+   * @return std::string_view
    */
-  auto getObjectName() const -> std::string;
+  auto getObjectName() const -> std::string_view;
+
+  /**
+   * @brief gets the enclosing scope of the object (e.g. ns::Class), empty at global scope
+   *
+   * @return std::string_view
+   */
+  auto getObjectScope() const -> std::string_view;
+
+  /**
+   * @brief gets the overload index of the object
+   *
+   * @return size_t
+   */
+  auto getOverloadIndex() const -> size_t;
+
+  /**
+   * @brief gets the line where the object starts
+   *
+   * @return size_t
+   */
+  auto getStartLine() const -> size_t;
+
+  /**
+   * @brief gets the column where the object starts
+   *
+   * @return size_t
+   */
+  auto getStartColumn() const -> size_t;
+
+  /**
+   * @brief gets the line where the object ends
+   *
+   * @return size_t
+   */
+  auto getEndLine() const -> size_t;
+
+  /**
+   * @brief gets the column where the object ends
+   *
+   * @return size_t
+   */
+  auto getEndColumn() const -> size_t;
+
+  /**
+   * @brief gets the raw comment attached to the object
+   *
+   * @return std::string_view
+   */
+  auto getRawComment() const -> std::string_view;
+
+  /**
+   * @brief gets the brief comment of the object
+   *
+   * @return std::string_view
+   */
+  auto getDebrief() const -> std::string_view;
+
+  /**
+   * @brief gets the argument names of the object
+   *
+   * @return const std::vector<std::string_view> &
+   */
+  auto getArguments() const -> const std::vector<std::string_view> &;
+
+  /**
+   * @brief gets the return type of the object
+   *
+   * @return std::string_view
+   */
+  auto getReturnType() const -> std::string_view;
 
   /**
    * @brief gets the object as a string
@@ -171,6 +266,13 @@ class Object {
    */
   auto getObjectPath() const -> fs::path;
 
+  /**
+   * @brief gets the path of the object without building a fs::path
+   *
+   * @return std::string_view
+   */
+  auto getObjectPathView() const -> std::string_view;
+
   /**
    * @brief gets the path of the object as a string
    *
@@ -199,7 +301,37 @@ class Object {
    */
   auto getObjectTypeAsString() const -> std::string;
 
+  /**
+   * @brief Calls visitor(key, field) on every stored field, in the key order of a dumped JSON object. This is the
+   * only list of the fields, the JSON and binary stores all go through it. Strings are interned views and
+   * "arguments" is an interned list
+   *
+   * @arg obj Object or const Object
+   * @arg visitor
+   *
+   * @return void
+   */
+  template <typename Self, typename Visitor>
+  static auto visitFields(Self &obj, Visitor &&visitor) -> void {
+    static_assert(std::is_same_v<std::remove_const_t<Self>, Object>);
+    visitor("arguments", obj.arguments_);
+    visitor("debrief", obj.debrief_);
+    visitor("end_column", obj.endColumn_);
+    visitor("end_line", obj.endLine_);
+    visitor("file_path", obj.filePath_);
+    visitor("name", obj.name_);
+    visitor("overload_index", obj.overloadIndex_);
+    visitor("raw_comment", obj.rawComment_);
+    visitor("return_type", obj.returnType_);
+    visitor("scope", obj.scope_);
+    visitor("start_column", obj.startColumn_);
+    visitor("start_line", obj.startLine_);
+    visitor("type", obj.type_);
+  }
+
  private:
+  friend class ConfigSaxHandler;
+
   /**
    * @brief gets the ObjectType from a string
    *
@@ -209,19 +341,38 @@ class Object {
    */
   auto getObjectTypeFromString(const std::string &typeStr) -> ObjectType;
 
-  fs::path filePath_;
-  std::string name_;
+  std::string_view filePath_;
+  std::string_view name_;
+  std::string_view scope_;
+  std::string_view rawComment_;
+  std::string_view debrief_;
+  std::string_view returnType_;
+  const std::vector<std::string_view> *arguments_;
+  uint32_t overloadIndex_;
+  uint32_t startLine_;
+  uint32_t startColumn_;
+  uint32_t endLine_;
+  uint32_t endColumn_;
   ObjectType type_;
-  size_t overloadIndex_;
-  size_t startLine_;
-  size_t startColumn_;
-  size_t endLine_;
-  size_t endColumn_;
-  std::string rawComment_;
-  std::string debrief_;
-  std::vector<std::string> arguments_;
-  std::string returnType_;
   ObjectState state_;
 };
 
+/**
+ * @brief Hashes objects by identity, meant for hash containers keyed on object pointers
+ *
+ * @struct ObjectIdentityHash
+ */
+struct ObjectIdentityHash {
+  auto operator()(const Object *obj) const -> size_t { return obj->getIdentityHash(); }
+};
+
+/**
+ * @brief Compares objects by identity, meant for hash containers keyed on object pointers
+ *
+ * @struct ObjectIdentityEqual
+ */
+struct ObjectIdentityEqual {
+  auto operator()(const Object *lhs, const Object *rhs) const -> bool { return *lhs == *rhs; }
+};
+
 #endif /* !OBJECT_HPP_ */
\ No newline at end of file
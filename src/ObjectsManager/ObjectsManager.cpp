@@ -1,155 +1,724 @@
 #include "ObjectsManager.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <set>
+
+#include "FilesManager/AtomicFile.hpp"
+#include "Profiler/AllocationTracker.hpp"
+#include "Profiler/Profiler.hpp"
+
+/**
+ * @brief Records the memory libclang reports for a translation unit
+ *
+ * @arg filePath
+ * @arg translationUnit
+ *
+ * @return void
+ */
+static auto recordTranslationUnitUsage(const fs::path &filePath, CXTranslationUnit translationUnit) -> void {
+  CXTUResourceUsage usage = clang_getCXTUResourceUsage(translationUnit);
+  std::vector<std::pair<std::string_view, size_t>> entries;
+  for (unsigned i = 0; i < usage.numEntries; ++i) {
+    const char *name = clang_getTUResourceUsageName(usage.entries[i].kind);
+    entries.emplace_back(name ? name : "unknown", usage.entries[i].amount);
+  }
+  clang_disposeCXTUResourceUsage(usage);
+  Profiler::global().recordTranslationUnit(filePath.string(), std::move(entries));
+}
 
 // "-include",
 // "/home/pibe/Projects/Toxidoc/mods/clang_qt_override.h",
 
 ObjectsManager::ObjectsManager(std::vector<std::string> wordsBlacklist, std::vector<std::string> typesBlacklist,
-                               fs::path modPath)
+                               fs::path modPath, ParseProfile parseProfile, bool retainTranslationUnits)
     : objects_({}),
       wordsBlacklist_(wordsBlacklist),
       typesBlacklist_(typesBlacklist),
-      currentFilePath_(""),
       modPath_(modPath),
-      moduleType_(ModuleType::None) {}
+      moduleType_(ModuleType::None),
+      parseProfile_(parseProfile),
+      flagSets_(1),
+      retainTranslationUnits_(retainTranslationUnits) {
+  flagSets_[0].compileArgs = {"-std=c++23", "-I."};
+  if (!modPath_.empty() && fs::exists(modPath_)) {
+    for (const auto &[modType, modName] : ModulesList) {
+      if (modPath_.filename().string() == modName) {
+        moduleType_ = modType;
+        flagSets_[0].compileArgs.push_back("-include");
+        flagSets_[0].compileArgs.push_back(modPath_.string());
+        break;
+      }
+    }
+  }
+}
+
+ObjectsManager::~ObjectsManager() {
+  for (auto &[path, translationUnit] : translationUnits_) clang_disposeTranslationUnit(translationUnit);
+  for (CXIndex index : indexes_)
+    if (index) clang_disposeIndex(index);
+}
 
 auto ObjectsManager::getObjectsList() const -> const std::vector<Object> & { return objects_; }
 
+auto ObjectsManager::getVisitedCursorsCount() const -> size_t { return visitedCursors_.load(); }
+
+auto ObjectsManager::getArenaAllocationsCount() const -> size_t { return arenaAllocations_.load(); }
+
+auto ObjectsManager::getArenaBlocksCount() const -> size_t { return arenaBlocks_.load(); }
+
 auto ObjectsManager::processHeaderFile(const fs::path &filePath) -> std::expected<void, std::string> {
-  CXIndex index = clang_createIndex(0, 0);
+  CXIndex index = getIndex(0);
   if (!index) { return std::unexpected("Failed to create Clang index"); }
 
-  std::vector<std::string> argsVec = {"-std=c++23", "-I."};
-  std::vector<const char *> args;
-  std::string modPathStr;
-  if (!modPath_.empty() && fs::exists(modPath_)) {
-    for (const auto &[modType, modName] : ModulesList) {
-      if (modPath_.filename().string() == modName) {
-        moduleType_ = modType;
-        argsVec.push_back("-include");
-        modPathStr = modPath_.string();
-        argsVec.push_back(modPathStr);
-        break;
+  return parseHeaderFile(index, filePath, objects_);
+}
+
+auto ObjectsManager::processHeaderFiles(const std::vector<fs::path> &filePaths, size_t jobs,
+                                        std::atomic<size_t> &processedFiles,
+                                        std::unordered_map<std::string, std::vector<Object>> &&cachedObjects)
+    -> std::vector<fs::path> {
+  std::vector<fs::path> failedFiles;
+  if (jobs == 0) jobs = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  jobs = std::min(jobs, filePaths.size());
+
+  if (jobs <= 1) {
+    CXIndex index = getIndex(0);
+    for (const auto &path : filePaths) {
+      processedFiles++;
+      auto cached = cachedObjects.find(path.string());
+      if (cached != cachedObjects.end()) {
+        AllocationScope allocationScope(Subsystem::Objects);
+        objects_.insert(objects_.end(), std::make_move_iterator(cached->second.begin()),
+                        std::make_move_iterator(cached->second.end()));
+        continue;
+      }
+      auto parseResult = index ? parseHeaderFile(index, path, objects_)
+                               : std::expected<void, std::string>(std::unexpected("Failed to create Clang index"));
+      if (!parseResult) {
+        spdlog::error("Error processing file {}: {}", path.string(), parseResult.error());
+        failedFiles.push_back(path);
       }
     }
+    return failedFiles;
   }
-  for (const auto &arg : argsVec) args.push_back(arg.c_str());
 
-  CXTranslationUnit translationUnit = nullptr;
-  CXErrorCode error = clang_parseTranslationUnit2(index, filePath.c_str(), args.data(), static_cast<int>(args.size()),
-                                                  nullptr, 0, CXTranslationUnit_None, &translationUnit);
-  if (!translationUnit || error != CXError_Success) {
-    clang_disposeIndex(index);
-    std::string errorMsg;
-    switch (error) {
-      case CXError_Failure: errorMsg = "Failure"; break;
-      case CXError_Crashed: errorMsg = "Crashed"; break;
-      case CXError_InvalidArguments: errorMsg = "Invalid Arguments"; break;
-      case CXError_ASTReadError: errorMsg = "AST Read Error"; break;
-      default: errorMsg = "Unknown Error"; break;
+  // slots are filled from this thread so workers never grow indexes_
+  std::vector<CXIndex> indexes;
+  for (size_t slot = 0; slot < jobs; ++slot) indexes.push_back(getIndex(slot));
+
+  std::vector<std::vector<Object>> buffers(filePaths.size());
+  std::vector<std::string> errors(filePaths.size());
+  std::atomic<size_t> nextFile = 0;
+  {
+    std::vector<std::jthread> workers;
+    for (CXIndex index : indexes) {
+      workers.emplace_back([&, index]() {
+        for (size_t i = nextFile++; i < filePaths.size(); i = nextFile++) {
+          auto cached = cachedObjects.find(filePaths[i].string());
+          // each file is taken by a single worker, moving its entry out never races
+          if (cached != cachedObjects.end()) {
+            buffers[i] = std::move(cached->second);
+          } else if (!index) {
+            errors[i] = "Failed to create Clang index";
+          } else {
+            auto parseResult = parseHeaderFile(index, filePaths[i], buffers[i]);
+            if (!parseResult) errors[i] = parseResult.error();
+          }
+          processedFiles++;
+        }
+      });
     }
-    return std::unexpected("Failed to parse translation unit, " + errorMsg);
   }
 
-  CXCursor rootCursor = clang_getTranslationUnitCursor(translationUnit);
-  currentFilePath_ = filePath;
+  AllocationScope allocationScope(Subsystem::Objects);
+  for (size_t i = 0; i < filePaths.size(); ++i) {
+    if (!errors[i].empty()) {
+      spdlog::error("Error processing file {}: {}", filePaths[i].string(), errors[i]);
+      failedFiles.push_back(filePaths[i]);
+    }
+    objects_.insert(objects_.end(), std::make_move_iterator(buffers[i].begin()),
+                    std::make_move_iterator(buffers[i].end()));
+  }
+  return failedFiles;
+}
+
+auto ObjectsManager::prepareWorkerSlots(size_t slots) -> void {
+  for (size_t slot = 0; slot < slots; ++slot) getIndex(slot);
+}
+
+auto ObjectsManager::parseHeaderFileInSlot(size_t slot, const fs::path &filePath, std::vector<Object> &objects)
+    -> std::expected<void, std::string> {
+  CXIndex index = slot < indexes_.size() ? indexes_[slot] : nullptr;
+  if (!index) return std::unexpected("Failed to create Clang index");
+  return parseHeaderFile(index, filePath, objects);
+}
+
+auto ObjectsManager::appendObjects(std::vector<Object> &&objects) -> void {
+  AllocationScope allocationScope(Subsystem::Objects);
+  objects_.insert(objects_.end(), std::make_move_iterator(objects.begin()), std::make_move_iterator(objects.end()));
+}
+
+auto ObjectsManager::replaceFileObjects(const fs::path &filePath, std::vector<Object> &&objects) -> void {
+  AllocationScope allocationScope(Subsystem::Objects);
+  // objects of a file are appended together, they form a single run
+  std::string pathStr = filePath.string();
+  auto isInFile = [&pathStr](const Object &obj) { return obj.getObjectPathView() == pathStr; };
+  auto first = std::find_if(objects_.begin(), objects_.end(), isInFile);
+  auto last = std::find_if_not(first, objects_.end(), isInFile);
+  std::vector<Object> previousObjects;
+  std::copy_if(first, last, std::back_inserter(previousObjects),
+               [](const Object &obj) { return obj.getState() != ObjectState::Removed; });
+  auto mergedObjects = mergeObjects(previousObjects, objects);
+  auto position = objects_.erase(first, last);
+  objects_.insert(position, std::make_move_iterator(mergedObjects.begin()),
+                  std::make_move_iterator(mergedObjects.end()));
+}
+
+auto ObjectsManager::mergeSavedObjects(const std::vector<Object> &savedObjects) -> void {
+  if (savedObjects.empty()) return;
+  AllocationScope allocationScope(Subsystem::Merge);
+  // paths are interned, the views stay valid as long as the objects
+  std::unordered_map<std::string_view, std::vector<Object>> savedByFile;
+  std::vector<std::string_view> savedFiles;
+  for (const auto &obj : savedObjects) {
+    auto [it, inserted] = savedByFile.try_emplace(obj.getObjectPathView());
+    if (inserted) savedFiles.push_back(obj.getObjectPathView());
+    it->second.push_back(obj);
+  }
+
+  std::vector<Object> mergedObjects;
+  mergedObjects.reserve(objects_.size() + savedObjects.size());
+  auto appendMerge = [&mergedObjects](const std::vector<Object> &saved, const std::vector<Object> &parsed) {
+    auto merged = mergeObjects(saved, parsed);
+    mergedObjects.insert(mergedObjects.end(), std::make_move_iterator(merged.begin()),
+                         std::make_move_iterator(merged.end()));
+  };
+  for (auto first = objects_.begin(); first != objects_.end();) {
+    std::string_view path = first->getObjectPathView();
+    auto last =
+        std::find_if(first, objects_.end(), [path](const Object &obj) { return obj.getObjectPathView() != path; });
+    std::vector<Object> parsed(std::make_move_iterator(first), std::make_move_iterator(last));
+    auto saved = savedByFile.find(path);
+    appendMerge(saved != savedByFile.end() ? saved->second : std::vector<Object>{}, parsed);
+    if (saved != savedByFile.end()) savedByFile.erase(saved);
+    first = last;
+  }
+  // files gone since the save only leave Removed objects
+  for (std::string_view path : savedFiles) {
+    auto saved = savedByFile.find(path);
+    if (saved != savedByFile.end()) appendMerge(saved->second, {});
+  }
+  objects_ = std::move(mergedObjects);
+}
+
+auto ObjectsManager::compactStrings() -> void {
+  AllocationScope allocationScope(Subsystem::Objects);
+  StringPool fresh;
+  std::vector<std::string_view> arguments;
+  for (auto &obj : objects_) {
+    Object::visitFields(obj, [&fresh, &arguments](std::string_view /*key*/, auto &field) {
+      using Field = std::remove_cvref_t<decltype(field)>;
+      if constexpr (std::is_same_v<Field, std::string_view>) {
+        field = fresh.intern(field);
+      } else if constexpr (std::is_pointer_v<Field>) {
+        arguments.clear();
+        for (std::string_view arg : *field) arguments.push_back(fresh.intern(arg));
+        field = fresh.internList(arguments);
+      }
+    });
+  }
+  // the previous strings end up in fresh and are freed with it
+  StringPool::global().swap(fresh);
+}
+
+auto ObjectsManager::setRetainTranslationUnits(bool retain) -> void { retainTranslationUnits_ = retain; }
+
+auto ObjectsManager::discardTranslationUnit(const fs::path &filePath) -> void {
+  std::lock_guard<std::mutex> lock(translationUnitsMutex_);
+  auto it = translationUnits_.find(filePath.string());
+  if (it == translationUnits_.end()) return;
+  clang_disposeTranslationUnit(it->second);
+  translationUnits_.erase(it);
+}
+
+auto ObjectsManager::parseHeaderFile(CXIndex index, const fs::path &filePath, std::vector<Object> &objects)
+    -> std::expected<void, std::string> {
+  AllocationScope allocationScope(Subsystem::Parse);
+  ScopedTimer parseTimer("file", "parse", &filePath);
+  auto translationUnit = acquireTranslationUnit(index, filePath);
+  parseTimer.stop();
+  if (!translationUnit) return std::unexpected(translationUnit.error());
+
+  ScopedTimer visitTimer("file", "visit", &filePath);
+  CXCursor rootCursor = clang_getTranslationUnitCursor(translationUnit.value());
+  // the main file handle is resolved once, the visitor then compares handles instead of canonical paths
+  VisitorContext context(this, filePath, clang_getFile(translationUnit.value(), filePath.c_str()), &objects);
 
   clang_visitChildren(
       rootCursor,
       [](CXCursor cursor, CXCursor parent, CXClientData clientData) {
-        ObjectsManager *manager = static_cast<ObjectsManager *>(clientData);
-        return manager->visitor(cursor, parent, clientData);
+        VisitorContext *context = static_cast<VisitorContext *>(clientData);
+        return context->manager->visitor(cursor, parent, clientData);
       },
-      this);
-
-  clang_disposeTranslationUnit(translationUnit);
-  clang_disposeIndex(index);
-  setOverloadCounter();
+      &context);
+  visitTimer.stop();
+  if (Profiler::global().isEnabled()) recordTranslationUnitUsage(filePath, translationUnit.value());
+
+  visitedCursors_ += context.visitedCursors;
+  arenaAllocations_ += context.arena.getAllocationsCount();
+  arenaBlocks_ += context.heap.getAllocationsCount();
+  releaseTranslationUnit(filePath, translationUnit.value());
   return {};
 }
 
-auto ObjectsManager::generateDocumentation() -> void {
-  std::map<std::string, std::vector<Object>> docsByFile;
-  for (const auto &obj : objects_) docsByFile[obj.getObjectPath().string()].push_back(obj);
-  size_t objectsProcessed = 0;
-  for (const auto &[filePath, objs] : docsByFile) {
-    spdlog::info("Processing file: {}", filePath);
+auto ObjectsManager::setCompilationDatabase(const CompilationDatabase *database) -> void {
+  flagSets_.resize(1);
+  compilationDatabase_ = database;
+  if (!database) return;
+  for (const auto &flags : database->getFlagSets()) {
+    FlagSet flagSet;
+    bool hasStandard = std::ranges::any_of(
+        flags, [](const std::string &flag) { return flag.starts_with("-std=") || flag.starts_with("--std="); });
+    if (!hasStandard) flagSet.compileArgs.push_back("-std=c++23");
+    flagSet.compileArgs.insert(flagSet.compileArgs.end(), flags.begin(), flags.end());
+    if (moduleType_ != ModuleType::None) {
+      flagSet.compileArgs.push_back("-include");
+      flagSet.compileArgs.push_back(modPath_.string());
+    }
+    flagSets_.push_back(std::move(flagSet));
+  }
+  spdlog::info("Compilation database: {} entries, {} distinct flag sets", database->getEntriesCount(),
+               database->getFlagSets().size());
+}
+
+/**
+ * @brief Gets the path of the precompiled header of a flag set, the default one at pchPath and the others numbered
+ * next to it
+ *
+ * @arg pchPath
+ * @arg flagSetIndex
+ *
+ * @return fs::path
+ */
+static auto getFlagSetPchPath(const fs::path &pchPath, size_t flagSetIndex) -> fs::path {
+  if (flagSetIndex == 0) return pchPath;
+  fs::path flagSetPchPath = pchPath;
+  return flagSetPchPath.replace_extension(fmt::format(".{}{}", flagSetIndex, pchPath.extension().string()));
+}
+
+/**
+ * @brief Removes the precompiled headers, stamps and prefixes numbered past the current flag sets, left by a run with
+ * a larger compilation database
+ *
+ * @arg pchPath
+ * @arg flagSetsCount
+ *
+ * @return void
+ */
+static auto removeStalePrecompiledHeaders(const fs::path &pchPath, size_t flagSetsCount) -> void {
+  std::string prefix = pchPath.stem().string() + ".";
+  std::string extension = pchPath.extension().string();
+  fs::path directory = pchPath.parent_path().empty() ? fs::path(".") : pchPath.parent_path();
+  std::error_code ec;
+  for (auto it = fs::directory_iterator(directory, ec); !ec && it != fs::directory_iterator(); it.increment(ec)) {
+    std::string name = it->path().filename().string();
+    if (!name.starts_with(prefix)) continue;
+    // "<stem>.<index><extension>" followed by nothing, ".stamp" or ".hpp"
+    size_t digitsEnd = name.find_first_not_of("0123456789", prefix.size());
+    if (digitsEnd == prefix.size() || digitsEnd == std::string::npos) continue;
+    std::string_view suffix = std::string_view(name).substr(digitsEnd);
+    if (!suffix.starts_with(extension)) continue;
+    suffix.remove_prefix(extension.size());
+    if (!suffix.empty() && suffix != ".stamp" && suffix != ".hpp") continue;
+    size_t flagSetIndex = std::stoul(name.substr(prefix.size(), digitsEnd - prefix.size()));
+    if (flagSetIndex > 0 && flagSetIndex < flagSetsCount) continue;
+    std::error_code removeEc;
+    if (fs::remove(it->path(), removeEc)) spdlog::info("Removed stale precompiled header file {}", name);
+  }
+}
+
+/**
+ * @brief Gets the size and time of a file as written in a precompiled header stamp
+ *
+ * @arg path
+ *
+ * @return std::string
+ */
+static auto getFileStamp(const fs::path &path) -> std::string {
+  std::error_code ec;
+  auto size = fs::file_size(path, ec);
+  if (ec) return "missing";
+  auto time = fs::last_write_time(path, ec);
+  if (ec) return "missing";
+  return std::to_string(size) + " " + std::to_string(time.time_since_epoch().count());
+}
+
+/**
+ * @brief Lists the files a translation unit includes with their size and time, one per line, the main file excluded
+ *
+ * @arg translationUnit
+ *
+ * @return std::string
+ */
+static auto getIncludedFilesStamp(CXTranslationUnit translationUnit) -> std::string {
+  std::set<std::string> includedFiles;
+  clang_getInclusions(
+      translationUnit,
+      [](CXFile file, CXSourceLocation *, unsigned includeDepth, CXClientData clientData) {
+        if (includeDepth == 0) return;
+        CXString nameCX = clang_getFileName(file);
+        if (const char *name = clang_getCString(nameCX))
+          static_cast<std::set<std::string> *>(clientData)->insert(name);
+        clang_disposeString(nameCX);
+      },
+      &includedFiles);
+  std::string stamp;
+  for (const auto &file : includedFiles) stamp += getFileStamp(file) + " " + file + "\n";
+  return stamp;
+}
 
-    CXIndex index = clang_createIndex(0, 0);
-    if (!index) {
-      spdlog::error("Failed to create Clang index for file: {}", filePath);
+/**
+ * @brief Tells if the files listed by getIncludedFilesStamp still have the same size and time
+ *
+ * @arg includedFilesStamp
+ *
+ * @return bool
+ */
+static auto areIncludedFilesUnchanged(std::string_view includedFilesStamp) -> bool {
+  while (!includedFilesStamp.empty()) {
+    size_t lineEnd = includedFilesStamp.find('\n');
+    if (lineEnd == std::string_view::npos) return false;
+    std::string_view line = includedFilesStamp.substr(0, lineEnd);
+    includedFilesStamp.remove_prefix(lineEnd + 1);
+    // "<size> <time> <path>", the path may hold spaces
+    size_t timeEnd = line.find(' ', line.find(' ') + 1);
+    if (timeEnd == std::string_view::npos) return false;
+    if (getFileStamp(fs::path(line.substr(timeEnd + 1))) != line.substr(0, timeEnd)) return false;
+  }
+  return true;
+}
+
+auto ObjectsManager::preparePrecompiledHeader(const fs::path &pchPath, const std::vector<std::string> &includes,
+                                              bool reuseOnly) -> std::expected<void, std::string> {
+  pchPath_ = pchPath;
+  pchReuseOnly_ = reuseOnly;
+  pchPrefix_.clear();
+  if (moduleType_ != ModuleType::None) pchPrefix_ += "#include \"" + fs::absolute(modPath_).string() + "\"\n";
+  for (const auto &include : includes) {
+    if (include.starts_with('<') || include.starts_with('"'))
+      pchPrefix_ += "#include " + include + "\n";
+    else
+      pchPrefix_ += "#include <" + include + ">\n";
+  }
+  for (auto &flagSet : flagSets_) flagSet.pchPrepared = std::make_unique<std::once_flag>();
+  if (pchPrefix_.empty()) return {};
+  if (!reuseOnly) removeStalePrecompiledHeaders(pchPath_, flagSets_.size());
+
+  // a database may hold hundreds of flag sets, only those of the parsed headers get a precompiled header
+  if (compilationDatabase_) return {};
+  std::expected<void, std::string> buildResult;
+  std::call_once(*flagSets_[0].pchPrepared, [&]() { buildResult = buildPrecompiledHeader(getIndex(0), 0); });
+  return buildResult;
+}
+
+auto ObjectsManager::getPreparedFlagSet(CXIndex index, size_t flagSetIndex) -> const FlagSet & {
+  FlagSet &flagSet = flagSets_[flagSetIndex];
+  if (pchPrefix_.empty()) return flagSet;
+  std::call_once(*flagSet.pchPrepared, [&]() {
+    // a flag set without precompiled header still parses, only slower
+    auto buildResult = buildPrecompiledHeader(index, flagSetIndex);
+    if (!buildResult) spdlog::warn("Precompiled header disabled: {}", buildResult.error());
+  });
+  return flagSet;
+}
+
+auto ObjectsManager::buildPrecompiledHeader(CXIndex index, size_t flagSetIndex) -> std::expected<void, std::string> {
+  FlagSet &flagSet = flagSets_[flagSetIndex];
+  fs::path pchPath = getFlagSetPchPath(pchPath_, flagSetIndex);
+  // the module include moves into the precompiled header
+  std::vector<std::string> baseArgs;
+  const auto &compileArgs = flagSet.compileArgs;
+  for (size_t i = 0; i < compileArgs.size(); ++i) {
+    if (compileArgs[i] == "-include" && i + 1 < compileArgs.size() && compileArgs[i + 1] == modPath_.string()) {
+      ++i;
       continue;
     }
-    const char *args[] = {"-std=c++23", "-I."};
-    CXTranslationUnit translationUnit = clang_parseTranslationUnit(
-        index, filePath.c_str(), args, sizeof(args) / sizeof(args[0]), nullptr, 0, CXTranslationUnit_None);
-    if (!translationUnit) {
-      spdlog::error("Failed to parse translation unit for file: {}", filePath);
-      clang_disposeIndex(index);
+    baseArgs.push_back(compileArgs[i]);
+  }
+
+  CXString versionCX = clang_getClangVersion();
+  const char *versionCStr = clang_getCString(versionCX);
+  std::string stamp = versionCStr ? versionCStr : "";
+  clang_disposeString(versionCX);
+  stamp += "\n";
+  for (const auto &arg : baseArgs) stamp += arg + "\n";
+  stamp += pchPrefix_;
+  // the included files follow, the module among them
+  stamp += "included files:\n";
+
+  fs::path stampPath = pchPath;
+  stampPath += ".stamp";
+  fs::path prefixPath = pchPath;
+  prefixPath += ".hpp";
+
+  std::string previousStamp;
+  if (std::ifstream stampFile(stampPath); stampFile.is_open())
+    previousStamp.assign(std::istreambuf_iterator<char>(stampFile), std::istreambuf_iterator<char>());
+
+  bool upToDate = previousStamp.starts_with(stamp) &&
+                  areIncludedFilesUnchanged(std::string_view(previousStamp).substr(stamp.size())) &&
+                  fs::exists(pchPath);
+  if (!upToDate && pchReuseOnly_) return std::unexpected(pchPath.string() + " is missing or outdated");
+  if (!upToDate) {
+    spdlog::info("Building precompiled header {}", pchPath.string());
+    auto prefixResult = AtomicFile::write(prefixPath, pchPrefix_);
+    if (!prefixResult) return std::unexpected("Failed to write precompiled header prefix: " + prefixResult.error());
+
+    if (!index) return std::unexpected("Failed to create Clang index");
+    std::vector<const char *> args;
+    for (const auto &arg : baseArgs) args.push_back(arg.c_str());
+    args.push_back("-x");
+    args.push_back("c++-header");
+
+    CXTranslationUnit translationUnit = nullptr;
+    CXErrorCode error = clang_parseTranslationUnit2(
+        index, prefixPath.c_str(), args.data(), static_cast<int>(args.size()), nullptr, 0,
+        CXTranslationUnit_ForSerialization | CXTranslationUnit_Incomplete, &translationUnit);
+    if (!translationUnit || error != CXError_Success)
+      return std::unexpected("Failed to parse precompiled header prefix");
+    stamp += getIncludedFilesStamp(translationUnit);
+    int saveResult =
+        clang_saveTranslationUnit(translationUnit, pchPath.c_str(), clang_defaultSaveOptions(translationUnit));
+    clang_disposeTranslationUnit(translationUnit);
+    if (saveResult != CXSaveError_None) return std::unexpected("Failed to save precompiled header");
+
+    // without its stamp the header is only rebuilt by the next run
+    auto stampResult = AtomicFile::write(stampPath, stamp);
+    if (!stampResult) spdlog::warn("Failed to write precompiled header stamp: {}", stampResult.error());
+  }
+
+  // a run that writes nothing leaves a stale header to the next one
+  if (!pchReuseOnly_) flagSet.stampPath = stampPath;
+  flagSet.fallbackArgs = flagSet.compileArgs;
+  flagSet.compileArgs = baseArgs;
+  flagSet.compileArgs.push_back("-include-pch");
+  flagSet.compileArgs.push_back(pchPath.string());
+  return {};
+}
+
+auto ObjectsManager::mergeObjects(const std::vector<Object> &savedObjects, const std::vector<Object> &parsedObjects)
+    -> std::vector<Object> {
+  AllocationScope allocationScope(Subsystem::Merge);
+  // emplace keeps the first saved object of a key, like the first match of a linear search
+  std::unordered_map<const Object *, size_t, ObjectIdentityHash, ObjectIdentityEqual> savedIndex;
+  savedIndex.reserve(savedObjects.size());
+  for (size_t i = 0; i < savedObjects.size(); ++i) savedIndex.emplace(&savedObjects[i], i);
+
+  std::unordered_set<const Object *, ObjectIdentityHash, ObjectIdentityEqual> parsedIndex;
+  parsedIndex.reserve(parsedObjects.size());
+  for (const auto &parsedObj : parsedObjects) parsedIndex.insert(&parsedObj);
+
+  std::vector<Object> mergedObjects;
+  mergedObjects.reserve(savedObjects.size() + parsedObjects.size());
+  for (const auto &savedObj : savedObjects) {
+    if (parsedIndex.contains(&savedObj)) continue;
+    mergedObjects.push_back(savedObj);
+    mergedObjects.back().setState(ObjectState::Removed);
+  }
+  for (const auto &parsedObj : parsedObjects) {
+    auto it = savedIndex.find(&parsedObj);
+    if (it == savedIndex.end()) {
+      mergedObjects.push_back(parsedObj);
+      mergedObjects.back().setState(ObjectState::Added);
       continue;
     }
-    CXRewriter rewriter = clang_CXRewriter_create(translationUnit);
-    if (!rewriter) {
-      spdlog::error("Failed to create Clang rewriter for file: {}", filePath);
-      clang_disposeTranslationUnit(translationUnit);
-      clang_disposeIndex(index);
-      continue;
+    mergedObjects.push_back(savedObjects[it->second]);
+    mergedObjects.back().updateObject(parsedObj);
+  }
+  return mergedObjects;
+}
+
+auto ObjectsManager::generateDocumentation(size_t jobs) -> void {
+  AllocationScope allocationScope(Subsystem::Generate);
+  // grouped by reference, paths are interned so the views stay valid
+  std::map<std::string_view, std::vector<const Object *>> docsByFile;
+  for (const auto &obj : objects_)
+    if (obj.getState() != ObjectState::Removed) docsByFile[obj.getObjectPathView()].push_back(&obj);
+  // insertion points were recorded during the scan, no second parse is needed
+  DocWriter writer(jobs);
+  for (const auto &[filePath, objs] : docsByFile) {
+    spdlog::info("Processing file: {}", filePath);
+    fs::path path(filePath);
+    for (const Object *obj : objs) {
+      if (obj->isValid() || !obj->getRawComment().empty()) continue;
+      size_t columnOffset = obj->getStartColumn();
+      writer.addInsertion(path, obj->getStartLine(), columnOffset, getDocForObject(*obj, columnOffset));
     }
+  }
+  size_t objectsProcessed = writer.flush();
+  spdlog::info("Total objects processed: {}", objectsProcessed);
+}
+
+auto ObjectsManager::getIndex(size_t slot) -> CXIndex {
+  while (indexes_.size() <= slot) indexes_.push_back(clang_createIndex(0, 0));
+  return indexes_[slot];
+}
+
+auto ObjectsManager::getFlagSetIndex(const fs::path &filePath) const -> size_t {
+  if (!compilationDatabase_) return 0;
+  auto flagSetIndex = compilationDatabase_->getFlagSetIndex(filePath);
+  if (!flagSetIndex || flagSetIndex.value() + 1 >= flagSets_.size()) return 0;
+  return flagSetIndex.value() + 1;
+}
 
-    for (const auto &obj : objs) {
-      json::json objJson = obj.getObjectAsJSON();
-      if (obj.isValid() || !objJson["raw_comment"].get<std::string>().empty()) continue;
-      size_t insertLine = objJson["start_line"].get<size_t>();
-      size_t columnOffset = objJson["start_column"].get<size_t>();
-      std::string docString = getDocForObject(obj, columnOffset);
-
-      CXSourceLocation insertLocation = clang_getLocation(
-          translationUnit, clang_getFile(translationUnit, filePath.c_str()), insertLine, columnOffset);
-      clang_CXRewriter_insertTextBefore(rewriter, insertLocation, docString.c_str());
-      clang_CXRewriter_overwriteChangedFiles(rewriter);
-      objectsProcessed++;
+auto ObjectsManager::acquireTranslationUnit(CXIndex index, const fs::path &filePath)
+    -> std::expected<CXTranslationUnit, std::string> {
+  CXTranslationUnit translationUnit = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(translationUnitsMutex_);
+    auto it = translationUnits_.find(filePath.string());
+    if (it != translationUnits_.end()) {
+      translationUnit = it->second;
+      translationUnits_.erase(it);
     }
+  }
+  if (translationUnit) {
+    if (clang_reparseTranslationUnit(translationUnit, 0, nullptr, clang_defaultReparseOptions(translationUnit)) == 0)
+      return translationUnit;
+    // a failed reparse leaves the unit unusable, fall back to a fresh parse
+    clang_disposeTranslationUnit(translationUnit);
+    translationUnit = nullptr;
+  }
+
+  const FlagSet &flagSet = getPreparedFlagSet(index, getFlagSetIndex(filePath));
+  std::vector<const char *> args;
+  for (const auto &arg : flagSet.compileArgs) args.push_back(arg.c_str());
 
-    clang_CXRewriter_dispose(rewriter);
+  unsigned options = getParseOptions();
+  if (retainTranslationUnits_) options |= CXTranslationUnit_PrecompiledPreamble;
+  CXErrorCode error = clang_parseTranslationUnit2(index, filePath.c_str(), args.data(), static_cast<int>(args.size()),
+                                                  nullptr, 0, options, &translationUnit);
+  if (error == CXError_ASTReadError && !flagSet.fallbackArgs.empty()) {
+    // the precompiled header went stale under us (e.g. a header changed during the run), parse without it, the next
+    // run rebuilds it without a stamp
+    std::error_code ec;
+    if (fs::remove(flagSet.stampPath, ec))
+      spdlog::warn("Precompiled header of {} is stale, it is rebuilt by the next run", filePath.string());
+    args.clear();
+    for (const auto &arg : flagSet.fallbackArgs) args.push_back(arg.c_str());
+    error = clang_parseTranslationUnit2(index, filePath.c_str(), args.data(), static_cast<int>(args.size()), nullptr,
+                                        0, options, &translationUnit);
+  }
+  if (!translationUnit || error != CXError_Success) {
+    std::string errorMsg;
+    switch (error) {
+      case CXError_Failure: errorMsg = "Failure"; break;
+      case CXError_Crashed: errorMsg = "Crashed"; break;
+      case CXError_InvalidArguments: errorMsg = "Invalid Arguments"; break;
+      case CXError_ASTReadError: errorMsg = "AST Read Error"; break;
+      default: errorMsg = "Unknown Error"; break;
+    }
+    return std::unexpected("Failed to parse translation unit, " + errorMsg);
+  }
+  return translationUnit;
+}
+
+auto ObjectsManager::releaseTranslationUnit(const fs::path &filePath, CXTranslationUnit translationUnit) -> void {
+  if (!retainTranslationUnits_) {
     clang_disposeTranslationUnit(translationUnit);
-    clang_disposeIndex(index);
+    return;
   }
-  spdlog::info("Total objects processed: {}", objectsProcessed);
+  std::lock_guard<std::mutex> lock(translationUnitsMutex_);
+  auto [it, inserted] = translationUnits_.emplace(filePath.string(), translationUnit);
+  if (!inserted) clang_disposeTranslationUnit(translationUnit);
+}
+
+auto ObjectsManager::getParseOptions() const -> unsigned {
+  if (parseProfile_ == ParseProfile::Full) return CXTranslationUnit_None;
+  return CXTranslationUnit_SkipFunctionBodies | CXTranslationUnit_Incomplete | CXTranslationUnit_KeepGoing;
 }
 
 auto ObjectsManager::getDocForObject(const Object &obj, size_t columnOffset) -> std::string {
-  json::json objJson = obj.getObjectAsJSON();
   std::string doc = "\n";
 
-  auto idt = [columnOffset]() { return std::string(columnOffset - 1, ' '); };
-  doc += idt() + "/**\n";
-  doc += idt() + " * @brief\n";
+  const std::string idt(columnOffset - 1, ' ');
+  doc += idt + "/**\n";
+  doc += idt + " * @brief\n";
 
   bool hasType = false;
   for (const auto &[type, docTag] : ObjectTypeStringDocMap) {
     if (obj.getObjectType() == type) {
       hasType = true;
-      doc += idt() + " *\n";
-      doc += idt() + " * " + docTag + " " + obj.getObjectName() + "\n";
+      doc += idt + " *\n";
+      doc += idt + " * " + docTag + " ";
+      doc += obj.getObjectName();
+      doc += "\n";
       break;
     }
   }
-  if (objJson.contains("arguments") && !objJson["arguments"].empty()) {
-    doc += idt() + " *\n";
-    for (const auto &arg : objJson["arguments"]) doc += idt() + " * @arg " + arg.get<std::string>() + "\n";
+  const auto &arguments = obj.getArguments();
+  if (!arguments.empty()) {
+    doc += idt + " *\n";
+    for (std::string_view arg : arguments) {
+      doc += idt + " * @arg ";
+      doc += arg;
+      doc += "\n";
+    }
   }
-  if (objJson.contains("return_type") && !objJson["return_type"].get<std::string>().empty()) {
-    doc += idt() + " *\n";
-    if (!objJson["return_type"].get<std::string>().empty())
-      doc += idt() + " * @return " + objJson["return_type"].get<std::string>() + "\n";
+  std::string_view returnType = obj.getReturnType();
+  if (!returnType.empty()) {
+    doc += idt + " *\n";
+    doc += idt + " * @return ";
+    doc += returnType;
+    doc += "\n";
   }
-  doc += idt() + " */\n";
-  doc += idt();
+  doc += idt + " */\n";
+  doc += idt;
   return doc;
 }
 
+/**
+ * @brief Views the text of a clang string, valid until the string is disposed
+ *
+ * @arg str
+ *
+ * @return std::string_view
+ */
+static auto getStringView(const CXString &str) -> std::string_view {
+  const char *cStr = clang_getCString(str);
+  return cStr ? cStr : "";
+}
+
+/**
+ * @brief Builds the qualified scope of a cursor from its semantic parents (e.g. ns::Class)
+ *
+ * @arg cursor
+ * @arg resource allocates the scope and its temporaries
+ *
+ * @return std::pmr::string
+ */
+static auto getCursorScope(CXCursor cursor, std::pmr::memory_resource *resource) -> std::pmr::string {
+  std::pmr::vector<CXString> spellings(resource);
+  for (CXCursor parent = clang_getCursorSemanticParent(cursor);
+       !clang_Cursor_isNull(parent) && clang_getCursorKind(parent) != CXCursor_TranslationUnit;
+       parent = clang_getCursorSemanticParent(parent))
+    spellings.push_back(clang_getCursorSpelling(parent));
+
+  std::pmr::string scope(resource);
+  for (auto it = spellings.rbegin(); it != spellings.rend(); ++it) {
+    std::string_view spelling = getStringView(*it);
+    if (!scope.empty()) scope += "::";
+    scope += spelling.empty() ? "(anonymous)" : spelling;
+    clang_disposeString(*it);
+  }
+  return scope;
+}
+
 auto ObjectsManager::visitor(CXCursor cursor, CXCursor parent, CXClientData clientData) -> CXChildVisitResult {
+  VisitorContext *context = static_cast<VisitorContext *>(clientData);
+  context->visitedCursors++;
   CXSourceLocation loc = clang_getCursorLocation(cursor);
   if (!clang_Location_isFromMainFile(loc)) return CXChildVisit_Continue;
 
@@ -158,16 +727,7 @@ auto ObjectsManager::visitor(CXCursor cursor, CXCursor parent, CXClientData clie
   clang_getSpellingLocation(loc, &cxFile, &line, &column, &offset);
 
   if (!cxFile) return CXChildVisit_Continue;
-
-  CXString cxFileName = clang_getFileName(cxFile);
-  const char *cFileName = clang_getCString(cxFileName);
-  std::string foundPath = cFileName ? cFileName : "";
-  clang_disposeString(cxFileName);
-
-  std::error_code ec;
-  fs::path asked = fs::weakly_canonical(currentFilePath_, ec);
-  fs::path found = fs::weakly_canonical(foundPath, ec);
-  if (asked != found) return CXChildVisit_Continue;
+  if (context->mainFile && !clang_File_isEqual(cxFile, context->mainFile)) return CXChildVisit_Continue;
 
   CXCursorKind kind = clang_getCursorKind(cursor);
   ObjectType objType = ObjectType::Unknown;
@@ -180,11 +740,10 @@ auto ObjectsManager::visitor(CXCursor cursor, CXCursor parent, CXClientData clie
             if (clang_getCursorKind(child) == CXCursor_AnnotateAttr) {
               CXString annotation = clang_getCursorSpelling(child);
               const char *annotationStr = clang_getCString(annotation);
-              std::string annotationString = annotationStr ? annotationStr : "";
 
               if (annotationStr) {
                 ObjectType *objTypePtr = static_cast<ObjectType *>(data);
-                std::string annot(annotationStr);
+                std::string_view annot(annotationStr);
                 if (annot == "qt_invokable") { *objTypePtr = ObjectType::Method; }
                 // else if (annot == "qt_signal") {
                 //   *objTypePtr = ObjectType::Unknown;
@@ -230,68 +789,55 @@ auto ObjectsManager::visitor(CXCursor cursor, CXCursor parent, CXClientData clie
     clang_getSpellingLocation(startLocation, nullptr, &startLine, &startColumn, nullptr);
     clang_getSpellingLocation(endLocation, nullptr, &endLine, &endColumn, nullptr);
 
+    // clang strings are only viewed, the object interns them once before they are disposed
     CXString nameCX = clang_getCursorSpelling(cursor);
-    const char *nameCStr = clang_getCString(nameCX);
-    std::string objectName = nameCStr ? nameCStr : "";
-    clang_disposeString(nameCX);
-
-    for (const auto &word : wordsBlacklist_)
-      if (objectName.contains(word)) return CXChildVisit_Continue;
+    std::string_view objectName = getStringView(nameCX);
+    for (const auto &word : wordsBlacklist_) {
+      if (objectName.contains(word)) {
+        clang_disposeString(nameCX);
+        return CXChildVisit_Continue;
+      }
+    }
 
-    std::vector<std::string> arguments;
+    std::pmr::vector<CXString> argumentsCX(&context->arena);
+    std::pmr::vector<std::string_view> arguments(&context->arena);
     if (objType == ObjectType::Function || objType == ObjectType::Method || objType == ObjectType::Constructor ||
         objType == ObjectType::Destructor || objType == ObjectType::FunctionTemplate) {
       int numArgs = clang_Cursor_getNumArguments(cursor);
+      argumentsCX.reserve(numArgs > 0 ? numArgs : 0);
+      arguments.reserve(argumentsCX.capacity());
       for (int i = 0; i < numArgs; ++i) {
-        CXCursor argCursor = clang_Cursor_getArgument(cursor, i);
-        CXString argNameCX = clang_getCursorSpelling(argCursor);
-        const char *argNameCStr = clang_getCString(argNameCX);
-        std::string argName = argNameCStr ? argNameCStr : "";
-        clang_disposeString(argNameCX);
-        arguments.push_back(argName);
+        argumentsCX.push_back(clang_getCursorSpelling(clang_Cursor_getArgument(cursor, i)));
+        arguments.push_back(getStringView(argumentsCX.back()));
       }
     }
 
-    CXType returnTypeCX = clang_getCursorResultType(cursor);
-    CXString returnTypeStrCX = clang_getTypeSpelling(returnTypeCX);
-    const char *returnTypeCStr = clang_getCString(returnTypeStrCX);
-    std::string returnType = returnTypeCStr ? returnTypeCStr : "";
-    clang_disposeString(returnTypeStrCX);
-
+    CXString returnTypeCX = clang_getTypeSpelling(clang_getCursorResultType(cursor));
     CXString rawCommentCX = clang_Cursor_getRawCommentText(cursor);
-    const char *rawCommentCStr = clang_getCString(rawCommentCX);
-    std::string rawComment = rawCommentCStr ? rawCommentCStr : "";
-    clang_disposeString(rawCommentCX);
-
     CXString debriefCX = clang_Cursor_getBriefCommentText(cursor);
-    const char *debriefCStr = clang_getCString(debriefCX);
-    std::string debrief = debriefCStr ? debriefCStr : "";
-    clang_disposeString(debriefCX);
+    std::pmr::string scope = getCursorScope(cursor, &context->arena);
+
+    // built in place in the output buffer, which is then moved as a whole
+    Object &object = context->objects->emplace_back(
+        context->filePath.native(), objectName, scope, objType, startLine, startColumn, endLine, endColumn,
+        getStringView(rawCommentCX), getStringView(debriefCX), arguments, getStringView(returnTypeCX),
+        ObjectState::Unchanged);
+    // overloads are numbered per translation unit and scope, starting at 1 for the first declaration
+    std::pmr::string overloadKey(scope, &context->arena);
+    overloadKey += "::";
+    overloadKey += objectName;
+    object.setOverloadIndex(++context->overloadCounters[std::move(overloadKey)]);
 
-    Object object(currentFilePath_, objectName, objType, startLine, startColumn, endLine, endColumn, rawComment,
-                  debrief, arguments, returnType, ObjectState::Unchanged);
-    objects_.push_back(object);
+    clang_disposeString(nameCX);
+    for (CXString &argumentCX : argumentsCX) clang_disposeString(argumentCX);
+    clang_disposeString(returnTypeCX);
+    clang_disposeString(rawCommentCX);
+    clang_disposeString(debriefCX);
   }
+  // bodies only hold statements and locals, declarations we document never live there
+  if (parseProfile_ == ParseProfile::DeclarationsOnly &&
+      (kind == CXCursor_FunctionDecl || kind == CXCursor_CXXMethod || kind == CXCursor_Constructor ||
+       kind == CXCursor_Destructor || kind == CXCursor_FunctionTemplate || kind == CXCursor_ConversionFunction))
+    return CXChildVisit_Continue;
   return CXChildVisit_Recurse;
 }
-
-auto ObjectsManager::setOverloadCounter() -> void {
-  std::map<std::string, size_t> overloadCounters;
-  for (const auto &obj : objects_) {
-    std::string key = obj.getObjectName();
-    overloadCounters[key] = 0;
-  }
-
-  size_t overload = 0;
-  for (auto &obj : objects_) {
-    std::string key = obj.getObjectName();
-    if (overloadCounters.find(key) != overloadCounters.end()) {
-      overloadCounters[key]++;
-      overload = overloadCounters[key];
-    } else {
-      overloadCounters[key] = 0;
-      overload = 0;
-    }
-    obj.setOverloadIndex(overload);
-  }
-}
\ No newline at end of file
@@ -2,14 +2,23 @@
 #define OBJECTSMANAGER_HPP_
 
 #include <clang-c/Index.h>
-#include <clang-c/Rewrite.h>
 #include <spdlog/spdlog.h>
 
+#include <atomic>
 #include <expected>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "CountingResource.hpp"
+#include "DocWriter/DocWriter.hpp"
+#include "FilesManager/CompilationDatabase.hpp"
 #include "Object.hpp"
 
 namespace fs = std::filesystem;
@@ -24,6 +33,16 @@ enum class ModuleType {
   QtOverride,
 };
 
+/**
+ * @brief Parse profiles used when building translation units
+ *
+ * @enum ParseProfile
+ */
+enum class ParseProfile {
+  Full,
+  DeclarationsOnly,
+};
+
 const std::map<ObjectType, std::string> ObjectTypeStringDocMap = {
     {ObjectType::Class, "@class"},
 };
@@ -43,14 +62,20 @@ class ObjectsManager {
    * @brief Constructs an ObjectsManager instance
    *
    * @param blacklist List of words to ignore when processing objects
+   * @param parseProfile DeclarationsOnly skips function bodies and tolerates incomplete translation units
+   * @param retainTranslationUnits Keeps translation units alive so a second pass on the same file reparses it
    */
   ObjectsManager(std::vector<std::string> wordsBlacklist = {}, std::vector<std::string> typesBlacklist = {},
-                 fs::path modPath = {});
+                 fs::path modPath = {}, ParseProfile parseProfile = ParseProfile::Full,
+                 bool retainTranslationUnits = false);
+
+  ObjectsManager(const ObjectsManager &) = delete;
+  auto operator=(const ObjectsManager &) -> ObjectsManager & = delete;
 
   /**
-   * @brief Destructor for ObjectsManager
+   * @brief Destructor for ObjectsManager, disposes the retained translation units and the Clang indexes
    */
-  ~ObjectsManager() = default;
+  ~ObjectsManager();
 
   /**
    * @brief returns the list of managed objects
@@ -59,6 +84,28 @@ class ObjectsManager {
    */
   auto getObjectsList() const -> const std::vector<Object> &;
 
+  /**
+   * @brief returns the number of cursors the visitor went through since construction
+   *
+   * @return size_t
+   */
+  auto getVisitedCursorsCount() const -> size_t;
+
+  /**
+   * @brief returns the number of temporary allocations the visitor served from its arenas since construction
+   *
+   * @return size_t
+   */
+  auto getArenaAllocationsCount() const -> size_t;
+
+  /**
+   * @brief returns the number of heap blocks the visitor arenas requested since construction, the heap allocations
+   * left on the visitor path besides the interned strings
+   *
+   * @return size_t
+   */
+  auto getArenaBlocksCount() const -> size_t;
+
   /**
    * @brief Processes a header file to extract objects
    *
@@ -68,14 +115,273 @@ class ObjectsManager {
    */
   auto processHeaderFile(const fs::path &filePath) -> std::expected<void, std::string>;
 
+  /**
+   * @brief Processes a list of header files, spreading them across worker threads
+   *
+   * Each worker owns its own Clang index and fills a private buffer per file, buffers are merged in the order of
+   * filePaths so the result is identical to a serial run. Files found in cachedObjects are not parsed, their cached
+   * objects, overload indexes included, take their place in the list
+   *
+   * @arg filePaths
+   * @arg jobs number of worker threads, 0 uses every available core
+   * @arg processedFiles incremented once per processed file by every worker
+   * @arg cachedObjects objects of unchanged files keyed by file path, moved into the list
+   *
+   * @return std::vector<fs::path> files that failed to parse
+   */
+  auto processHeaderFiles(const std::vector<fs::path> &filePaths, size_t jobs, std::atomic<size_t> &processedFiles,
+                          std::unordered_map<std::string, std::vector<Object>> &&cachedObjects = {})
+      -> std::vector<fs::path>;
+
+  /**
+   * @brief Creates the Clang indexes of the given number of worker slots, must be called from a single thread before
+   * parseHeaderFileInSlot is used concurrently
+   *
+   * @arg slots
+   *
+   * @return void
+   */
+  auto prepareWorkerSlots(size_t slots) -> void;
+
+  /**
+   * @brief Parses a header file with the Clang index of a worker slot, safe to call concurrently with distinct slots
+   *
+   * @arg slot index of a slot created by prepareWorkerSlots
+   * @arg filePath
+   * @arg objects receives the objects found in the file
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto parseHeaderFileInSlot(size_t slot, const fs::path &filePath, std::vector<Object> &objects)
+      -> std::expected<void, std::string>;
+
+  /**
+   * @brief Appends objects parsed outside of processHeaderFiles to the managed list
+   *
+   * @arg objects
+   *
+   * @return void
+   */
+  auto appendObjects(std::vector<Object> &&objects) -> void;
+
+  /**
+   * @brief Replaces the objects of one file with their merge into the previous ones, they keep the place the file had
+   * in the list. Previous objects already Removed were not saved, they are left out of the merge
+   *
+   * @arg filePath
+   * @arg objects new objects of the file, empty when the file is gone
+   *
+   * @return void
+   */
+  auto replaceFileObjects(const fs::path &filePath, std::vector<Object> &&objects) -> void;
+
+  /**
+   * @brief Merges the managed objects with the saved ones file by file, the objects of a file stay together. Nothing
+   * is merged without saved objects, like a first run
+   *
+   * @arg savedObjects
+   *
+   * @return void
+   */
+  auto mergeSavedObjects(const std::vector<Object> &savedObjects) -> void;
+
+  /**
+   * @brief Moves the strings of the managed objects to a fresh string pool which replaces the global one, the strings
+   * of replaced objects are freed. Every other view into the global pool becomes dangling, and no thread may intern
+   * meanwhile
+   *
+   * @return void
+   */
+  auto compactStrings() -> void;
+
+  /**
+   * @brief Keeps or stops keeping the translation units of the next parses, already retained units stay
+   *
+   * @arg retain
+   *
+   * @return void
+   */
+  auto setRetainTranslationUnits(bool retain) -> void;
+
+  /**
+   * @brief Disposes the retained translation unit of a file, if any
+   *
+   * @arg filePath
+   *
+   * @return void
+   */
+  auto discardTranslationUnit(const fs::path &filePath) -> void;
+
+  /**
+   * @brief Parses headers with the flags of a compilation database instead of the default ones, a header the database
+   * does not cover keeps the defaults. Must be called before preparePrecompiledHeader
+   *
+   * @arg database must outlive the manager, nullptr restores the defaults
+   *
+   * @return void
+   */
+  auto setCompilationDatabase(const CompilationDatabase *database) -> void;
+
+  /**
+   * @brief Builds, or reuses when its inputs did not change, a precompiled header holding the module and the common
+   * includes, every following parse then loads it instead of preprocessing the same preamble again
+   *
+   * One precompiled header is built per distinct flag set, the first at pchPath and the others next to it. Without a
+   * compilation database the default one is built at once, otherwise each is built by the first header parsed with
+   * its flag set, and the headers of flag sets the database no longer has are removed. Its stamp holds the size and
+   * time of every file it includes, a change to any of them rebuilds it
+   *
+   * @arg pchPath
+   * @arg includes
+   * @arg reuseOnly If true, nothing is written, a missing or outdated precompiled header is not used
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto preparePrecompiledHeader(const fs::path &pchPath, const std::vector<std::string> &includes,
+                                bool reuseOnly = false) -> std::expected<void, std::string>;
+
+  /**
+   * @brief Merges the objects saved in the config with freshly parsed ones in linear time
+   *
+   * Saved objects missing from the parse are kept as Removed, parsed objects matching a saved one update it, the
+   * others are Added. The order and states are the same as comparing every pair of objects
+   *
+   * @arg savedObjects
+   * @arg parsedObjects
+   *
+   * @return std::vector<Object>
+   */
+  static auto mergeObjects(const std::vector<Object> &savedObjects, const std::vector<Object> &parsedObjects)
+      -> std::vector<Object>;
+
   /**
    * @brief Generates documentation for the managed objects
    *
+   * @arg jobs number of files written concurrently, 0 uses every available core
+   *
    * @return void
    */
-  auto generateDocumentation() -> void;
+  auto generateDocumentation(size_t jobs = 1) -> void;
 
  private:
+  // first arena block of a translation unit walk, enough for the temporaries of most headers
+  static constexpr size_t ArenaInitialSize = 16 * 1024;
+
+  /**
+   * @brief State handed to the clang visitor while walking a translation unit
+   *
+   * Temporaries of the walk are allocated in a monotonic arena owned by the context and released at once with it
+   *
+   * @struct VisitorContext
+   */
+  struct VisitorContext {
+    VisitorContext(ObjectsManager *owner, fs::path path, CXFile file, std::vector<Object> *output)
+        : manager(owner), filePath(std::move(path)), mainFile(file), objects(output) {}
+
+    ObjectsManager *manager;
+    fs::path filePath;
+    CXFile mainFile;
+    std::vector<Object> *objects;
+    size_t visitedCursors = 0;
+    CountingResource heap;
+    std::pmr::monotonic_buffer_resource arenaBuffer{ArenaInitialSize, &heap};
+    CountingResource arena{&arenaBuffer};
+    std::pmr::unordered_map<std::pmr::string, size_t> overloadCounters{&arena};
+  };
+
+  /**
+   * @brief Arguments a header is parsed with
+   *
+   * @struct FlagSet
+   */
+  struct FlagSet {
+    std::vector<std::string> compileArgs;
+    std::vector<std::string> fallbackArgs;
+    // stamp of the precompiled header, dropped once the header turns out stale so that the next run rebuilds it
+    fs::path stampPath;
+    // the precompiled header is prepared by the first parse with the flag set
+    std::unique_ptr<std::once_flag> pchPrepared = std::make_unique<std::once_flag>();
+  };
+
+  /**
+   * @brief Gets the index of the flag set of a header, the default one when no compilation database covers it
+   *
+   * @arg filePath
+   *
+   * @return size_t
+   */
+  auto getFlagSetIndex(const fs::path &filePath) const -> size_t;
+
+  /**
+   * @brief Gets a flag set, its precompiled header is built first if it was not yet
+   *
+   * @arg index used to parse the precompiled header
+   * @arg flagSetIndex
+   *
+   * @return const FlagSet &
+   */
+  auto getPreparedFlagSet(CXIndex index, size_t flagSetIndex) -> const FlagSet &;
+
+  /**
+   * @brief Builds the precompiled header of one flag set, or reuses it when its stamp did not change
+   *
+   * @arg index
+   * @arg flagSetIndex switched to the precompiled header on success
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto buildPrecompiledHeader(CXIndex index, size_t flagSetIndex) -> std::expected<void, std::string>;
+
+  /**
+   * @brief Parses a header file with the given index and appends its objects to the output buffer
+   *
+   * @arg index
+   * @arg filePath
+   * @arg objects
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto parseHeaderFile(CXIndex index, const fs::path &filePath, std::vector<Object> &objects)
+      -> std::expected<void, std::string>;
+
+  /**
+   * @brief Gets the session Clang index of a worker slot, creating it on first use
+   *
+   * Indexes must be created from the main thread before workers use their slot
+   *
+   * @arg slot
+   *
+   * @return CXIndex
+   */
+  auto getIndex(size_t slot) -> CXIndex;
+
+  /**
+   * @brief Gets a translation unit for a file, reparsing the retained one when the file was already parsed
+   *
+   * @arg index
+   * @arg filePath
+   *
+   * @return std::expected<CXTranslationUnit, std::string>
+   */
+  auto acquireTranslationUnit(CXIndex index, const fs::path &filePath) -> std::expected<CXTranslationUnit, std::string>;
+
+  /**
+   * @brief Gives back a translation unit obtained with acquireTranslationUnit, keeping it when retention is enabled
+   *
+   * @arg filePath
+   * @arg translationUnit
+   *
+   * @return void
+   */
+  auto releaseTranslationUnit(const fs::path &filePath, CXTranslationUnit translationUnit) -> void;
+
+  /**
+   * @brief Gets the clang translation unit flags matching the parse profile
+   *
+   * @return unsigned
+   */
+  auto getParseOptions() const -> unsigned;
+
   /**
    * @brief creates documentation string for an object
    *
@@ -97,19 +403,27 @@ class ObjectsManager {
    */
   auto visitor(CXCursor cursor, CXCursor parent, CXClientData clientData) -> CXChildVisitResult;
 
-  /**
-   * @brief Sets overload counters for objects with the same name
-   *
-   * @return void
-   */
-  auto setOverloadCounter() -> void;
-
   std::vector<std::string> wordsBlacklist_;
   std::vector<std::string> typesBlacklist_;
   std::vector<Object> objects_;
-  fs::path currentFilePath_;
   fs::path modPath_;
   ModuleType moduleType_;
+  ParseProfile parseProfile_;
+  // the default flag set comes first, then one per flag set of the compilation database
+  std::vector<FlagSet> flagSets_;
+  // precompiled header of the default flag set, the others are numbered next to it
+  fs::path pchPath_;
+  // empty when no precompiled header is used
+  std::string pchPrefix_;
+  bool pchReuseOnly_ = false;
+  const CompilationDatabase *compilationDatabase_ = nullptr;
+  bool retainTranslationUnits_;
+  std::vector<CXIndex> indexes_;
+  std::unordered_map<std::string, CXTranslationUnit> translationUnits_;
+  std::mutex translationUnitsMutex_;
+  std::atomic<size_t> visitedCursors_ = 0;
+  std::atomic<size_t> arenaAllocations_ = 0;
+  std::atomic<size_t> arenaBlocks_ = 0;
 };
 
 #endif /* !OBJECTSMANAGER_HPP_ */
\ No newline at end of file
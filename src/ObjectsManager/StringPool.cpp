@@ -0,0 +1,112 @@
+#include "StringPool.hpp"
+
+#include <cstring>
+#include <functional>
+
+#include "Profiler/AllocationTracker.hpp"
+
+auto StringPool::global() -> StringPool & {
+  static StringPool pool;
+  return pool;
+}
+
+auto StringPool::intern(std::string_view str) -> std::string_view {
+  if (str.empty()) return {};
+  AllocationScope allocationScope(Subsystem::Objects);
+  size_t hash = std::hash<std::string_view>{}(str);
+  Shard &shard = shards_[hash % ShardsCount];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.strings.find(str);
+  if (it != shard.strings.end()) return *it;
+  std::string_view stored = store(shard, str);
+  shard.strings.insert(stored);
+  return stored;
+}
+
+auto StringPool::store(Shard &shard, std::string_view str) -> std::string_view {
+  char *destination = nullptr;
+  if (str.size() > BlockSize / 16) {
+    // long strings (mostly comments) get a block of their own instead of wasting the end of the current one
+    shard.blocks.push_back(std::make_unique_for_overwrite<char[]>(str.size()));
+    shard.arenaBytes += str.size();
+    destination = shard.blocks.back().get();
+  } else {
+    if (!shard.currentBlock || shard.blockUsed + str.size() > BlockSize) {
+      shard.blocks.push_back(std::make_unique_for_overwrite<char[]>(BlockSize));
+      shard.arenaBytes += BlockSize;
+      shard.currentBlock = shard.blocks.back().get();
+      shard.blockUsed = 0;
+    }
+    destination = shard.currentBlock + shard.blockUsed;
+    shard.blockUsed += str.size();
+  }
+  std::memcpy(destination, str.data(), str.size());
+  return {destination, str.size()};
+}
+
+auto StringPool::internList(std::span<const std::string_view> strings) -> const std::vector<std::string_view> * {
+  if (strings.empty()) return emptyList();
+  AllocationScope allocationScope(Subsystem::Objects);
+  std::vector<std::string_view> candidate(strings.begin(), strings.end());
+  std::lock_guard<std::mutex> lock(listsMutex_);
+  auto it = listIndex_.find(&candidate);
+  if (it != listIndex_.end()) return *it;
+  lists_.push_back(std::move(candidate));
+  listIndex_.insert(&lists_.back());
+  return &lists_.back();
+}
+
+auto StringPool::emptyList() -> const std::vector<std::string_view> * {
+  static const std::vector<std::string_view> empty;
+  return &empty;
+}
+
+auto StringPool::swap(StringPool &other) -> void {
+  for (size_t i = 0; i < ShardsCount; ++i) {
+    Shard &shard = shards_[i];
+    Shard &otherShard = other.shards_[i];
+    std::scoped_lock lock(shard.mutex, otherShard.mutex);
+    shard.strings.swap(otherShard.strings);
+    shard.blocks.swap(otherShard.blocks);
+    std::swap(shard.currentBlock, otherShard.currentBlock);
+    std::swap(shard.blockUsed, otherShard.blockUsed);
+    std::swap(shard.arenaBytes, otherShard.arenaBytes);
+  }
+  // swapping the containers keeps the lists where they are, the pointers handed out follow them
+  std::scoped_lock lock(listsMutex_, other.listsMutex_);
+  lists_.swap(other.lists_);
+  listIndex_.swap(other.listIndex_);
+}
+
+auto StringPool::getStringsCount() -> size_t {
+  size_t count = 0;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    count += shard.strings.size();
+  }
+  return count;
+}
+
+auto StringPool::getArenaBytes() -> size_t {
+  size_t bytes = 0;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    bytes += shard.arenaBytes;
+  }
+  return bytes;
+}
+
+auto StringPool::ListHash::operator()(const std::vector<std::string_view> *list) const -> size_t {
+  size_t hash = list->size();
+  for (std::string_view str : *list)
+    hash ^= std::hash<const char *>{}(str.data()) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+auto StringPool::ListEqual::operator()(const std::vector<std::string_view> *lhs,
+                                       const std::vector<std::string_view> *rhs) const -> bool {
+  if (lhs->size() != rhs->size()) return false;
+  for (size_t i = 0; i < lhs->size(); ++i)
+    if ((*lhs)[i].data() != (*rhs)[i].data() || (*lhs)[i].size() != (*rhs)[i].size()) return false;
+  return true;
+}
@@ -0,0 +1,134 @@
+#ifndef STRINGPOOL_HPP_
+#define STRINGPOOL_HPP_
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Process-wide pool interning the strings held by objects
+ *
+ * Every distinct string is stored once in an append-only arena, so the views handed out stay valid as long as the
+ * pool keeps its content and equal strings share the same address. A long-lived process compacts the global pool by
+ * interning its live strings in a fresh pool and swapping the two. Objects of the same header share their path, and
+ * common spellings (void, auto, the empty comment) cost nothing after the first one. Argument lists are interned the
+ * same way. Safe to use from several threads, the strings are spread over shards locked independently
+ *
+ * @class StringPool
+ */
+class StringPool {
+ public:
+  /**
+   * @brief Gets the pool shared by every object
+   *
+   * @return StringPool &
+   */
+  static auto global() -> StringPool &;
+
+  /**
+   * @brief Gets the stored copy of a string, adding it when it is new
+   *
+   * @arg str
+   *
+   * @return std::string_view valid as long as the pool keeps its content
+   */
+  auto intern(std::string_view str) -> std::string_view;
+
+  /**
+   * @brief Gets the stored copy of a list of strings, its elements must already be interned
+   *
+   * @arg strings
+   *
+   * @return const std::vector<std::string_view> * valid as long as the pool keeps its content
+   */
+  auto internList(std::span<const std::string_view> strings) -> const std::vector<std::string_view> *;
+
+  /**
+   * @brief Gets the empty list, shared by every object without arguments
+   *
+   * @return const std::vector<std::string_view> *
+   */
+  static auto emptyList() -> const std::vector<std::string_view> *;
+
+  /**
+   * @brief Exchanges the content of two pools, views handed out by one stay valid as long as the other lives. Neither
+   * pool may be used by another thread meanwhile
+   *
+   * @arg other
+   *
+   * @return void
+   */
+  auto swap(StringPool &other) -> void;
+
+  /**
+   * @brief Gets the number of distinct strings stored
+   *
+   * @return size_t
+   */
+  auto getStringsCount() -> size_t;
+
+  /**
+   * @brief Gets the bytes reserved by the arena
+   *
+   * @return size_t
+   */
+  auto getArenaBytes() -> size_t;
+
+ private:
+  static constexpr size_t ShardsCount = 16;
+  static constexpr size_t BlockSize = 64 * 1024;
+
+  /**
+   * @brief Strings of one shard and the arena blocks holding them
+   *
+   * @struct Shard
+   */
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_set<std::string_view> strings;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char *currentBlock = nullptr;
+    size_t blockUsed = 0;
+    size_t arenaBytes = 0;
+  };
+
+  /**
+   * @brief Hashes a list of interned strings by address
+   *
+   * @struct ListHash
+   */
+  struct ListHash {
+    auto operator()(const std::vector<std::string_view> *list) const -> size_t;
+  };
+
+  /**
+   * @brief Compares lists of interned strings by address
+   *
+   * @struct ListEqual
+   */
+  struct ListEqual {
+    auto operator()(const std::vector<std::string_view> *lhs, const std::vector<std::string_view> *rhs) const -> bool;
+  };
+
+  /**
+   * @brief Copies a string into the arena of a shard, the shard must be locked
+   *
+   * @arg shard
+   * @arg str
+   *
+   * @return std::string_view
+   */
+  static auto store(Shard &shard, std::string_view str) -> std::string_view;
+
+  std::array<Shard, ShardsCount> shards_;
+  std::mutex listsMutex_;
+  std::deque<std::vector<std::string_view>> lists_;
+  std::unordered_set<const std::vector<std::string_view> *, ListHash, ListEqual> listIndex_;
+};
+
+#endif /* !STRINGPOOL_HPP_ */
@@ -0,0 +1,80 @@
+#ifndef BOUNDEDQUEUE_HPP_
+#define BOUNDEDQUEUE_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+/**
+ * @brief Blocking multi-producer multi-consumer queue with a fixed capacity, producers wait while it is full so a
+ * fast stage cannot run ahead of a slow one
+ *
+ * @class BoundedQueue
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  /**
+   * @brief Constructs a BoundedQueue
+   *
+   * @arg capacity maximum number of queued items, at least 1
+   */
+  explicit BoundedQueue(size_t capacity) : capacity_(capacity == 0 ? 1 : capacity) {}
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  auto operator=(const BoundedQueue &) -> BoundedQueue & = delete;
+
+  /**
+   * @brief Queues an item, waiting for room
+   *
+   * @arg item
+   *
+   * @return bool false if the queue was closed, the item is then dropped
+   */
+  auto push(T item) -> bool {
+    std::unique_lock lock(mutex_);
+    notFull_.wait(lock, [this]() { return closed_ || items_.size() < capacity_; });
+    if (closed_) return false;
+    items_.push_back(std::move(item));
+    notEmpty_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Takes the oldest item, waiting for one
+   *
+   * @return std::optional<T> empty once the queue is closed and drained
+   */
+  auto pop() -> std::optional<T> {
+    std::unique_lock lock(mutex_);
+    notEmpty_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+    if (items_.empty()) return std::nullopt;
+    T item = std::move(items_.front());
+    items_.pop_front();
+    notFull_.notify_one();
+    return item;
+  }
+
+  /**
+   * @brief Closes the queue, pending items can still be popped but no new one is accepted
+   *
+   * @return void
+   */
+  auto close() -> void {
+    std::lock_guard lock(mutex_);
+    closed_ = true;
+    notEmpty_.notify_all();
+    notFull_.notify_all();
+  }
+
+ private:
+  size_t capacity_;
+  bool closed_ = false;
+  std::deque<T> items_;
+  std::mutex mutex_;
+  std::condition_variable notEmpty_;
+  std::condition_variable notFull_;
+};
+
+#endif /* !BOUNDEDQUEUE_HPP_ */
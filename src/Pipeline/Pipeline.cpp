@@ -0,0 +1,114 @@
+#include "Pipeline.hpp"
+
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+Pipeline::Pipeline(FilesManager &filesManager, ObjectsManager &objectsManager, size_t jobs, size_t queueCapacity)
+    : filesManager_(filesManager),
+      objectsManager_(objectsManager),
+      jobs_(jobs == 0 ? std::max<size_t>(std::thread::hardware_concurrency(), 1) : jobs),
+      queueCapacity_(queueCapacity == 0 ? jobs_ * 4 : queueCapacity) {}
+
+auto Pipeline::run(std::atomic<size_t> &processedFiles) -> std::expected<PipelineResult, std::string> {
+  auto startTime = std::chrono::steady_clock::now();
+  BoundedQueue<fs::path> pathQueue(queueCapacity_);
+  BoundedQueue<ParsedFile> parsedQueue(queueCapacity_);
+
+  // indexes are created here, workers only read their own slot
+  objectsManager_.prepareWorkerSlots(jobs_);
+
+  std::expected<void, std::string> discoveryResult;
+  std::jthread discovery([&]() {
+    discoveryResult = filesManager_.initSources([&](const fs::path &filePath) { pathQueue.push(filePath); });
+    pathQueue.close();
+  });
+
+  std::atomic<size_t> activeWorkers = jobs_;
+  std::vector<std::jthread> workers;
+  for (size_t slot = 0; slot < jobs_; ++slot) {
+    workers.emplace_back([&, slot]() {
+      while (auto filePath = pathQueue.pop()) {
+        ParsedFile parsed{filePath.value(), {}, false, {}};
+        if (auto cached = filesManager_.getUnchangedFileObjects(parsed.path)) {
+          parsed.objects = std::move(cached.value());
+          parsed.cached = true;
+        } else {
+          auto parseResult = objectsManager_.parseHeaderFileInSlot(slot, parsed.path, parsed.objects);
+          if (!parseResult) parsed.error = parseResult.error();
+        }
+        processedFiles++;
+        parsedQueue.push(std::move(parsed));
+      }
+      // the last worker out ends the merge stage
+      if (--activeWorkers == 0) parsedQueue.close();
+    });
+  }
+
+  // saved objects are merged file by file, a file missing from this run is handled once the queues are drained
+  auto savedFiles = filesManager_.getSavedObjectFiles();
+  std::unordered_set<std::string> unseenSavedFiles(savedFiles.begin(), savedFiles.end());
+  bool mergeNeeded = !unseenSavedFiles.empty();
+
+  PipelineResult result;
+  result.merged = mergeNeeded;
+  // files arrive in scheduling order, they are assembled in source order once discovery is over
+  std::unordered_map<std::string, MergedFile> filesByPath;
+  bool firstMerged = false;
+  while (auto parsed = parsedQueue.pop()) {
+    std::string pathStr = parsed->path.string();
+    if (!parsed->error.empty()) spdlog::error("Error processing file {}: {}", pathStr, parsed->error);
+    if (parsed->cached) result.cachedFiles++;
+    MergedFile &file = filesByPath[pathStr];
+    file.failed = !parsed->error.empty();
+    if (mergeNeeded) {
+      file.merged = ObjectsManager::mergeObjects(filesManager_.getSavedFileObjects(parsed->path), parsed->objects);
+      file.removedCount = file.merged.size() - parsed->objects.size();
+      unseenSavedFiles.erase(pathStr);
+    }
+    file.parsed = std::move(parsed->objects);
+    if (!firstMerged) {
+      firstMerged = true;
+      auto elapsed = std::chrono::steady_clock::now() - startTime;
+      spdlog::info("First file merged after {} ms",
+                   std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+    }
+  }
+  workers.clear();
+  discovery.join();
+  if (!discoveryResult) return std::unexpected(discoveryResult.error());
+
+  for (const auto &filePath : unseenSavedFiles) {
+    MergedFile &file = filesByPath[filePath];
+    file.merged = ObjectsManager::mergeObjects(filesManager_.getSavedFileObjects(filePath), {});
+    file.removedCount = file.merged.size();
+  }
+
+  // same order as the phased run: parsed objects by source, then removed saved objects in saved order ahead of the
+  // merged parsed ones, which holds as long as the saved objects are grouped by file, as every save writes them
+  const auto &sourcePaths = filesManager_.getSourcePaths();
+  for (const auto &sourcePath : sourcePaths) {
+    auto it = filesByPath.find(sourcePath.string());
+    if (it == filesByPath.end()) continue;
+    if (it->second.failed) result.failedFiles.push_back(sourcePath);
+    objectsManager_.appendObjects(std::move(it->second.parsed));
+  }
+  if (!mergeNeeded) return result;
+  for (const auto &filePath : savedFiles) {
+    auto it = filesByPath.find(filePath);
+    if (it == filesByPath.end()) continue;
+    auto &merged = it->second.merged;
+    result.mergedObjects.insert(result.mergedObjects.end(), std::make_move_iterator(merged.begin()),
+                                std::make_move_iterator(merged.begin() + it->second.removedCount));
+  }
+  for (const auto &sourcePath : sourcePaths) {
+    auto it = filesByPath.find(sourcePath.string());
+    if (it == filesByPath.end()) continue;
+    auto &merged = it->second.merged;
+    result.mergedObjects.insert(result.mergedObjects.end(),
+                                std::make_move_iterator(merged.begin() + it->second.removedCount),
+                                std::make_move_iterator(merged.end()));
+  }
+  return result;
+}
@@ -0,0 +1,95 @@
+#ifndef PIPELINE_HPP_
+#define PIPELINE_HPP_
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "BoundedQueue.hpp"
+#include "FilesManager/FilesManager.hpp"
+#include "ObjectsManager/ObjectsManager.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Outcome of a pipelined run
+ *
+ * @struct PipelineResult
+ */
+struct PipelineResult {
+  bool merged = false;
+  std::vector<Object> mergedObjects;
+  std::vector<fs::path> failedFiles;
+  size_t cachedFiles = 0;
+};
+
+/**
+ * @brief Runs discovery, parsing and merging as overlapping stages joined by bounded queues
+ *
+ * Walker threads push each header they find to the parse queue, parse workers push each file's objects (or the saved
+ * ones of an unchanged file) to the merge queue, and the calling thread merges every file with its saved objects as
+ * soon as it arrives. Full queues make the upstream stage wait, memory stays bounded whatever the tree size
+ *
+ * @class Pipeline
+ */
+class Pipeline {
+ public:
+  /**
+   * @brief Constructs a Pipeline
+   *
+   * @arg filesManager settings must already be loaded, its sources are collected by the pipeline
+   * @arg objectsManager receives the parsed objects
+   * @arg jobs number of parse workers, 0 uses every available core
+   * @arg queueCapacity capacity of each queue, 0 picks four items per worker
+   */
+  Pipeline(FilesManager &filesManager, ObjectsManager &objectsManager, size_t jobs, size_t queueCapacity = 0);
+
+  /**
+   * @brief Runs the stages until every discovered file is merged
+   *
+   * Results are assembled in the order of the source paths, the same order as the phased run whatever the thread
+   * scheduling
+   *
+   * @arg processedFiles incremented once per file leaving the parse stage
+   *
+   * @return std::expected<PipelineResult, std::string>
+   */
+  auto run(std::atomic<size_t> &processedFiles) -> std::expected<PipelineResult, std::string>;
+
+ private:
+  /**
+   * @brief Objects of one file travelling from the parse stage to the merge stage
+   *
+   * @struct ParsedFile
+   */
+  struct ParsedFile {
+    fs::path path;
+    std::vector<Object> objects;
+    bool cached = false;
+    std::string error;
+  };
+
+  /**
+   * @brief Results of one file kept by the merge stage until every file is in
+   *
+   * @struct MergedFile
+   */
+  struct MergedFile {
+    std::vector<Object> parsed;
+    // removed saved objects first, then the parsed ones merged with the saved ones
+    std::vector<Object> merged;
+    size_t removedCount = 0;
+    bool failed = false;
+  };
+
+  FilesManager &filesManager_;
+  ObjectsManager &objectsManager_;
+  size_t jobs_;
+  size_t queueCapacity_;
+};
+
+#endif /* !PIPELINE_HPP_ */
@@ -0,0 +1,109 @@
+#include "AllocationTracker.hpp"
+
+#if defined(TOXIDOC_ALLOC_TRACKING)
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @brief Counters of one subsystem, updated from any thread
+ *
+ * @struct AllocationCounters
+ */
+struct AllocationCounters {
+  std::atomic<size_t> allocations = 0;
+  std::atomic<size_t> bytes = 0;
+  std::atomic<size_t> liveBytes = 0;
+  std::atomic<size_t> peakLiveBytes = 0;
+};
+
+/**
+ * @brief Placed before every tracked allocation, keeps the returned pointer aligned as malloc would
+ *
+ * @struct AllocationHeader
+ */
+struct alignas(std::max_align_t) AllocationHeader {
+  size_t size;
+  Subsystem subsystem;
+};
+
+// constant-initialized, both are usable by allocations made before main and during static destruction
+static constinit std::array<AllocationCounters, static_cast<size_t>(Subsystem::Generate) + 1> counters;
+static constinit thread_local Subsystem currentSubsystem = Subsystem::Other;
+
+/**
+ * @brief Allocates a block and charges it to the subsystem of the calling thread
+ *
+ * @arg size
+ *
+ * @return void * nullptr when malloc fails
+ */
+static auto trackedAllocate(size_t size) -> void * {
+  auto *header = static_cast<AllocationHeader *>(std::malloc(sizeof(AllocationHeader) + size));
+  if (!header) return nullptr;
+  header->size = size;
+  header->subsystem = currentSubsystem;
+  AllocationCounters &counter = counters[static_cast<size_t>(currentSubsystem)];
+  counter.allocations.fetch_add(1, std::memory_order_relaxed);
+  counter.bytes.fetch_add(size, std::memory_order_relaxed);
+  size_t liveBytes = counter.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+  size_t peakLiveBytes = counter.peakLiveBytes.load(std::memory_order_relaxed);
+  while (liveBytes > peakLiveBytes &&
+         !counter.peakLiveBytes.compare_exchange_weak(peakLiveBytes, liveBytes, std::memory_order_relaxed)) {}
+  return header + 1;
+}
+
+/**
+ * @brief Frees a block returned by trackedAllocate
+ *
+ * @arg ptr
+ *
+ * @return void
+ */
+static auto trackedFree(void *ptr) -> void {
+  if (!ptr) return;
+  AllocationHeader *header = static_cast<AllocationHeader *>(ptr) - 1;
+  counters[static_cast<size_t>(header->subsystem)].liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+  std::free(header);
+}
+
+AllocationScope::AllocationScope(Subsystem subsystem) : previous_(currentSubsystem) { currentSubsystem = subsystem; }
+
+AllocationScope::~AllocationScope() { currentSubsystem = previous_; }
+
+auto AllocationTracker::getStats(Subsystem subsystem) -> AllocationStats {
+  const AllocationCounters &counter = counters[static_cast<size_t>(subsystem)];
+  return {counter.allocations.load(std::memory_order_relaxed), counter.bytes.load(std::memory_order_relaxed),
+          counter.liveBytes.load(std::memory_order_relaxed), counter.peakLiveBytes.load(std::memory_order_relaxed)};
+}
+
+// aligned forms are left to the standard library, they are allocated and freed by their own pair of operators
+auto operator new(size_t size) -> void * {
+  void *ptr = trackedAllocate(size ? size : 1);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+auto operator new[](size_t size) -> void * { return operator new(size); }
+
+auto operator new(size_t size, const std::nothrow_t &) noexcept -> void * { return trackedAllocate(size ? size : 1); }
+
+auto operator new[](size_t size, const std::nothrow_t &) noexcept -> void * {
+  return trackedAllocate(size ? size : 1);
+}
+
+auto operator delete(void *ptr) noexcept -> void { trackedFree(ptr); }
+
+auto operator delete[](void *ptr) noexcept -> void { trackedFree(ptr); }
+
+auto operator delete(void *ptr, size_t) noexcept -> void { trackedFree(ptr); }
+
+auto operator delete[](void *ptr, size_t) noexcept -> void { trackedFree(ptr); }
+
+auto operator delete(void *ptr, const std::nothrow_t &) noexcept -> void { trackedFree(ptr); }
+
+auto operator delete[](void *ptr, const std::nothrow_t &) noexcept -> void { trackedFree(ptr); }
+#else
+auto AllocationTracker::getStats(Subsystem) -> AllocationStats { return {}; }
+#endif
@@ -0,0 +1,113 @@
+#ifndef ALLOCATIONTRACKER_HPP_
+#define ALLOCATIONTRACKER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * @brief Parts of Toxidoc the allocations are charged to
+ *
+ * @enum Subsystem
+ */
+enum class Subsystem : uint8_t {
+  Other,
+  Walk,
+  Parse,
+  Objects,
+  Merge,
+  Store,
+  Index,
+  Generate,
+};
+
+const std::map<Subsystem, std::string> SubsystemStringMap = {
+    {Subsystem::Other, "other"},     {Subsystem::Walk, "walk"},   {Subsystem::Parse, "parse"},
+    {Subsystem::Objects, "objects"}, {Subsystem::Merge, "merge"}, {Subsystem::Store, "store"},
+    {Subsystem::Index, "index"},     {Subsystem::Generate, "generate"},
+};
+
+/**
+ * @brief Allocations charged to a subsystem, freed memory stays charged to the subsystem that allocated it
+ *
+ * @struct AllocationStats
+ */
+struct AllocationStats {
+  size_t allocations = 0;
+  size_t bytes = 0;
+  size_t liveBytes = 0;
+  size_t peakLiveBytes = 0;
+};
+
+/**
+ * @brief Counts the allocations made through the global operator new, by subsystem
+ *
+ * Only builds configured with the alloc_tracking option (TOXIDOC_ALLOC_TRACKING) replace the global allocator, every
+ * allocation then carries a small header naming its subsystem and size. Other builds keep the standard allocator and
+ * report nothing
+ *
+ * @class AllocationTracker
+ */
+class AllocationTracker {
+ public:
+  /**
+   * @brief Tells if the global allocator is replaced in this build
+   *
+   * @return bool
+   */
+  static constexpr auto isEnabled() -> bool {
+#if defined(TOXIDOC_ALLOC_TRACKING)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * @brief Gets the allocations charged to a subsystem so far
+   *
+   * @arg subsystem
+   *
+   * @return AllocationStats all zero when the allocator is not replaced
+   */
+  static auto getStats(Subsystem subsystem) -> AllocationStats;
+};
+
+/**
+ * @brief Charges the allocations of the calling thread to a subsystem until the end of the scope
+ *
+ * Scopes nest, the previous subsystem is restored on exit. Does nothing unless the allocator is replaced
+ *
+ * @class AllocationScope
+ */
+class AllocationScope {
+ public:
+  /**
+   * @brief Charges the following allocations of the calling thread to a subsystem
+   *
+   * @arg subsystem
+   */
+  explicit AllocationScope(Subsystem subsystem);
+
+  AllocationScope(const AllocationScope &) = delete;
+  auto operator=(const AllocationScope &) -> AllocationScope & = delete;
+
+  /**
+   * @brief Restores the subsystem charged before the scope
+   */
+  ~AllocationScope();
+
+ private:
+#if defined(TOXIDOC_ALLOC_TRACKING)
+  Subsystem previous_;
+#endif
+};
+
+#if !defined(TOXIDOC_ALLOC_TRACKING)
+inline AllocationScope::AllocationScope(Subsystem) {}
+
+inline AllocationScope::~AllocationScope() {}
+#endif
+
+#endif /* !ALLOCATIONTRACKER_HPP_ */
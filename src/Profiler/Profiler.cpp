@@ -0,0 +1,248 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+#include "AllocationTracker.hpp"
+
+namespace json = nlohmann;
+
+/**
+ * @brief Converts bytes to megabytes for display
+ *
+ * @arg bytes
+ *
+ * @return double
+ */
+static auto toMegabytes(size_t bytes) -> double { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+
+auto Profiler::global() -> Profiler & {
+  static Profiler profiler;
+  return profiler;
+}
+
+auto Profiler::enable() -> void {
+  origin_ = Clock::now();
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+auto Profiler::getThreadId() -> uint32_t {
+  static std::atomic<uint32_t> nextThreadId = 1;
+  thread_local uint32_t threadId = nextThreadId++;
+  return threadId;
+}
+
+auto Profiler::record(std::string_view category, std::string_view name, std::string file, Clock::time_point start,
+                      Clock::time_point end) -> void {
+  double startUs = std::chrono::duration<double, std::micro>(start - origin_).count();
+  double durationUs = std::chrono::duration<double, std::micro>(end - start).count();
+  uint32_t threadId = getThreadId();
+  MemoryUsage memory = category == "phase" ? readMemoryUsage() : MemoryUsage{};
+  std::lock_guard<std::mutex> lock(eventsMutex_);
+  if (events_.size() >= MaxEvents) {
+    droppedEvents_++;
+    return;
+  }
+  events_.push_back({category, name, std::move(file), startUs, durationUs, threadId, memory});
+}
+
+auto Profiler::getDroppedEventsCount() const -> size_t {
+  std::lock_guard<std::mutex> lock(eventsMutex_);
+  return droppedEvents_;
+}
+
+auto Profiler::recordTranslationUnit(std::string file, std::vector<std::pair<std::string_view, size_t>> entries)
+    -> void {
+  TranslationUnitUsage usage{file, 0, std::move(entries)};
+  for (const auto &[name, amount] : usage.entries) usage.totalBytes += amount;
+  std::lock_guard<std::mutex> lock(eventsMutex_);
+  translationUnits_.insert_or_assign(std::move(file), std::move(usage));
+}
+
+auto Profiler::getLargestTranslationUnits(size_t count) const -> std::vector<TranslationUnitUsage> {
+  std::vector<TranslationUnitUsage> usages;
+  {
+    std::lock_guard<std::mutex> lock(eventsMutex_);
+    for (const auto &[file, usage] : translationUnits_) usages.push_back(usage);
+  }
+  count = std::min(count, usages.size());
+  std::partial_sort(usages.begin(), usages.begin() + count, usages.end(),
+                    [](const TranslationUnitUsage &lhs, const TranslationUnitUsage &rhs) {
+                      return lhs.totalBytes > rhs.totalBytes;
+                    });
+  usages.resize(count);
+  return usages;
+}
+
+auto Profiler::readMemoryUsage() -> MemoryUsage {
+  MemoryUsage usage;
+#if defined(__linux__)
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    // values are in kB
+    if (line.starts_with("VmRSS:")) usage.rssBytes = std::stoull(line.substr(6)) * 1024;
+    else if (line.starts_with("VmHWM:")) usage.peakRssBytes = std::stoull(line.substr(6)) * 1024;
+  }
+#endif
+  return usage;
+}
+
+auto Profiler::resetPeakMemory() -> void {
+#if defined(__linux__)
+  std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+auto Profiler::getSlowestFiles(size_t count) const -> std::vector<FileTiming> {
+  std::vector<FileTiming> timings;
+  {
+    std::unordered_map<std::string_view, size_t> indexByFile;
+    std::lock_guard<std::mutex> lock(eventsMutex_);
+    for (const auto &event : events_) {
+      if (event.category != "file") continue;
+      auto [it, inserted] = indexByFile.try_emplace(event.file, timings.size());
+      if (inserted) timings.push_back({event.file});
+      // a header reparsed by the daemon adds up
+      FileTiming &timing = timings[it->second];
+      (event.name == "visit" ? timing.visitMs : timing.parseMs) += event.durationUs / 1000.0;
+    }
+  }
+  auto total = [](const FileTiming &timing) { return timing.parseMs + timing.visitMs; };
+  count = std::min(count, timings.size());
+  std::partial_sort(timings.begin(), timings.begin() + count, timings.end(),
+                    [&total](const FileTiming &lhs, const FileTiming &rhs) { return total(lhs) > total(rhs); });
+  timings.resize(count);
+  return timings;
+}
+
+auto Profiler::writeTrace(const fs::path &tracePath, size_t slowestCount) const -> std::expected<void, std::string> {
+  json::json traceEvents = json::json::array();
+  {
+    std::lock_guard<std::mutex> lock(eventsMutex_);
+    for (const auto &event : events_) {
+      json::json traceEvent = {{"name", std::string(event.name)}, {"cat", std::string(event.category)},
+                               {"ph", "X"}, {"ts", event.startUs}, {"dur", event.durationUs}, {"pid", 1},
+                               {"tid", event.threadId}};
+      if (!event.file.empty()) traceEvent["args"] = {{"file", event.file}};
+      if (event.category == "phase")
+        traceEvent["args"] = {{"rss_bytes", event.memory.rssBytes}, {"peak_rss_bytes", event.memory.peakRssBytes}};
+      traceEvents.push_back(std::move(traceEvent));
+      if (event.category != "phase") continue;
+      traceEvents.push_back({{"name", "memory"},
+                             {"ph", "C"},
+                             {"ts", event.startUs + event.durationUs},
+                             {"pid", 1},
+                             {"args",
+                              {{"rss_mb", toMegabytes(event.memory.rssBytes)},
+                               {"peak_rss_mb", toMegabytes(event.memory.peakRssBytes)}}}});
+    }
+  }
+
+  json::json slowestHeaders = json::json::array();
+  for (const auto &timing : getSlowestFiles(slowestCount))
+    slowestHeaders.push_back({{"file", timing.path}, {"parse_ms", timing.parseMs}, {"visit_ms", timing.visitMs}});
+
+  json::json largestTranslationUnits = json::json::array();
+  for (const auto &usage : getLargestTranslationUnits(slowestCount)) {
+    json::json resources = json::json::object();
+    for (const auto &[name, amount] : usage.entries) resources[std::string(name)] = amount;
+    largestTranslationUnits.push_back({{"file", usage.path}, {"bytes", usage.totalBytes}, {"resources", resources}});
+  }
+
+  json::json allocations = json::json::object();
+  if (AllocationTracker::isEnabled()) {
+    for (const auto &[subsystem, subsystemName] : SubsystemStringMap) {
+      AllocationStats stats = AllocationTracker::getStats(subsystem);
+      allocations[subsystemName] = {{"allocations", stats.allocations},
+                                    {"bytes", stats.bytes},
+                                    {"live_bytes", stats.liveBytes},
+                                    {"peak_live_bytes", stats.peakLiveBytes}};
+    }
+  }
+
+  json::json trace = {
+      {"traceEvents", std::move(traceEvents)},
+      {"displayTimeUnit", "ms"},
+      {"slowestHeaders", std::move(slowestHeaders)},
+      {"largestTranslationUnits", std::move(largestTranslationUnits)},
+      {"allocations", std::move(allocations)},
+  };
+  if (size_t dropped = getDroppedEventsCount(); dropped > 0)
+    spdlog::warn("Trace is missing the last {} scopes, only the first {} are kept", dropped, MaxEvents);
+  std::ofstream traceFile(tracePath, std::ios::binary | std::ios::trunc);
+  if (!traceFile.is_open()) return std::unexpected("Failed to open " + tracePath.string());
+  traceFile << trace.dump();
+  if (!traceFile) return std::unexpected("Failed to write " + tracePath.string());
+  return {};
+}
+
+auto Profiler::logSummary(size_t slowestCount) const -> void {
+  // time and memory of the phases sharing a name
+  struct PhaseSummary {
+    std::string_view name;
+    double ms = 0;
+    size_t peakRssBytes = 0;
+    size_t rssBytes = 0;
+  };
+
+  // phases of the same name, the reparses of the daemon for instance, are added up in order of first appearance
+  std::vector<PhaseSummary> phases;
+  {
+    std::lock_guard<std::mutex> lock(eventsMutex_);
+    for (const auto &event : events_) {
+      if (event.category != "phase") continue;
+      auto it = std::ranges::find(phases, event.name, &PhaseSummary::name);
+      PhaseSummary &phase = it != phases.end() ? *it : phases.emplace_back(PhaseSummary{event.name});
+      phase.ms += event.durationUs / 1000.0;
+      phase.peakRssBytes = std::max(phase.peakRssBytes, event.memory.peakRssBytes);
+      phase.rssBytes = event.memory.rssBytes;
+    }
+  }
+  if (size_t dropped = getDroppedEventsCount(); dropped > 0)
+    spdlog::warn("Profile is missing the last {} scopes, only the first {} are kept", dropped, MaxEvents);
+  spdlog::info("Profile per phase:");
+  for (const auto &phase : phases)
+    spdlog::info("  {:<12} {:>10.2f} ms, peak RSS {:>8.1f} MB, RSS after {:>8.1f} MB", phase.name, phase.ms,
+                 toMegabytes(phase.peakRssBytes), toMegabytes(phase.rssBytes));
+
+  auto largestTranslationUnits = getLargestTranslationUnits(slowestCount);
+  if (!largestTranslationUnits.empty()) {
+    spdlog::info("Largest translation units:");
+    for (const auto &usage : largestTranslationUnits)
+      spdlog::info("  {:>10.2f} MB {}", toMegabytes(usage.totalBytes), usage.path);
+  }
+
+  if (AllocationTracker::isEnabled()) {
+    spdlog::info("Allocations per subsystem:");
+    for (const auto &[subsystem, subsystemName] : SubsystemStringMap) {
+      AllocationStats stats = AllocationTracker::getStats(subsystem);
+      if (stats.allocations == 0) continue;
+      spdlog::info("  {:<10} {:>12} allocations, {:>10.1f} MB, peak live {:>8.1f} MB, live {:>8.1f} MB",
+                   subsystemName, stats.allocations, toMegabytes(stats.bytes), toMegabytes(stats.peakLiveBytes),
+                   toMegabytes(stats.liveBytes));
+    }
+  }
+
+  auto slowestFiles = getSlowestFiles(slowestCount);
+  if (slowestFiles.empty()) return;
+  spdlog::info("Slowest headers:");
+  for (const auto &timing : slowestFiles)
+    spdlog::info("  {:>10.2f} ms (parse {:.2f} ms, visit {:.2f} ms) {}", timing.parseMs + timing.visitMs,
+                 timing.parseMs, timing.visitMs, timing.path);
+}
+
+ProfileSession::ProfileSession(fs::path tracePath, size_t slowestCount, bool verbose)
+    : tracePath_(std::move(tracePath)), slowestCount_(slowestCount), enabled_(verbose || !tracePath_.empty()) {
+  if (enabled_) Profiler::global().enable();
+}
+
+ProfileSession::~ProfileSession() {
+  if (!enabled_) return;
+  Profiler::global().logSummary(slowestCount_);
+  if (tracePath_.empty()) return;
+  auto writeResult = Profiler::global().writeTrace(tracePath_, slowestCount_);
+  if (!writeResult) spdlog::error("Failed to write profile: {}", writeResult.error());
+  else spdlog::info("Profile written to {}", tracePath_.string());
+}
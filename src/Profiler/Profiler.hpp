@@ -0,0 +1,292 @@
+#ifndef PROFILER_HPP_
+#define PROFILER_HPP_
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Time spent on one header, split between building its translation unit and visiting it
+ *
+ * @struct FileTiming
+ */
+struct FileTiming {
+  std::string path;
+  double parseMs = 0;
+  double visitMs = 0;
+};
+
+/**
+ * @brief Resident memory of the process, zero where /proc is not available
+ *
+ * @struct MemoryUsage
+ */
+struct MemoryUsage {
+  size_t rssBytes = 0;
+  size_t peakRssBytes = 0;
+};
+
+/**
+ * @brief Memory libclang reports for the translation unit of one header
+ *
+ * @struct TranslationUnitUsage
+ */
+struct TranslationUnitUsage {
+  std::string path;
+  size_t totalBytes = 0;
+  // resource names come from clang_getTUResourceUsageName, they are static strings
+  std::vector<std::pair<std::string_view, size_t>> entries;
+};
+
+/**
+ * @brief Process-wide recorder of scoped timings, exported as Chrome trace events
+ *
+ * Disabled until enable is called, a disabled profiler costs a relaxed atomic load per scope and records nothing.
+ * Events come from any thread, each one keeps the small id of the thread it ran on. Phases also record the resident
+ * memory at their end and its peak while they ran. At most MaxEvents scopes are kept, a long running daemon stops
+ * recording past them and only counts what it dropped
+ *
+ * @class Profiler
+ */
+class Profiler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Gets the profiler shared by every module
+   *
+   * @return Profiler &
+   */
+  static auto global() -> Profiler &;
+
+  /**
+   * @brief Starts recording, timestamps are relative to this call
+   *
+   * @return void
+   */
+  auto enable() -> void;
+
+  /**
+   * @brief Tells if scopes are recorded
+   *
+   * @return bool
+   */
+  auto isEnabled() const -> bool { return enabled_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Records a finished scope
+   *
+   * @arg category "phase", "file" or "store"
+   * @arg name
+   * @arg file header the scope worked on, empty for the others
+   * @arg start
+   * @arg end
+   *
+   * @return void
+   */
+  auto record(std::string_view category, std::string_view name, std::string file, Clock::time_point start,
+              Clock::time_point end) -> void;
+
+  /**
+   * @brief Gets the number of scopes dropped once MaxEvents were recorded
+   *
+   * @return size_t
+   */
+  auto getDroppedEventsCount() const -> size_t;
+
+  /**
+   * @brief Records the memory libclang uses for the translation unit of a header, a later record of the same header
+   * replaces it
+   *
+   * @arg file
+   * @arg entries amount of each resource in bytes
+   *
+   * @return void
+   */
+  auto recordTranslationUnit(std::string file, std::vector<std::pair<std::string_view, size_t>> entries) -> void;
+
+  /**
+   * @brief Gets the headers whose translation unit used the most memory
+   *
+   * @arg count
+   *
+   * @return std::vector<TranslationUnitUsage>
+   */
+  auto getLargestTranslationUnits(size_t count) const -> std::vector<TranslationUnitUsage>;
+
+  /**
+   * @brief Reads the current and peak resident memory of the process
+   *
+   * @return MemoryUsage
+   */
+  static auto readMemoryUsage() -> MemoryUsage;
+
+  /**
+   * @brief Resets the peak resident memory to the current one, so the next reading gives the peak since this call.
+   * Where the kernel does not allow it, the next reading gives the peak of the process
+   *
+   * @return void
+   */
+  static auto resetPeakMemory() -> void;
+
+  /**
+   * @brief Gets the headers that took the longest, parse and visit times added up
+   *
+   * @arg count
+   *
+   * @return std::vector<FileTiming>
+   */
+  auto getSlowestFiles(size_t count) const -> std::vector<FileTiming>;
+
+  /**
+   * @brief Writes the recorded scopes as Chrome trace-event JSON, loadable in chrome://tracing or Perfetto
+   *
+   * Memory after each phase is added as counter events. The slowest headers, the largest translation units and the
+   * allocations per subsystem are added under "slowestHeaders", "largestTranslationUnits" and "allocations", trace
+   * viewers ignore them
+   *
+   * @arg tracePath
+   * @arg slowestCount
+   *
+   * @return std::expected<void, std::string>
+   */
+  auto writeTrace(const fs::path &tracePath, size_t slowestCount) const -> std::expected<void, std::string>;
+
+  /**
+   * @brief Logs the time and memory of each phase, the slowest headers, the largest translation units and the
+   * allocations per subsystem
+   *
+   * @arg slowestCount
+   *
+   * @return void
+   */
+  auto logSummary(size_t slowestCount) const -> void;
+
+ private:
+  // two scopes per header, a run over a million headers still fits
+  static constexpr size_t MaxEvents = size_t(1) << 21;
+
+  /**
+   * @brief A finished scope, times in microseconds since enable, memory is only read for phases
+   *
+   * @struct TraceEvent
+   */
+  struct TraceEvent {
+    std::string_view category;
+    std::string_view name;
+    std::string file;
+    double startUs;
+    double durationUs;
+    uint32_t threadId;
+    MemoryUsage memory;
+  };
+
+  /**
+   * @brief Gets the small id of the calling thread, ids are given in order of first use
+   *
+   * @return uint32_t
+   */
+  static auto getThreadId() -> uint32_t;
+
+  std::atomic<bool> enabled_ = false;
+  Clock::time_point origin_;
+  mutable std::mutex eventsMutex_;
+  std::vector<TraceEvent> events_;
+  size_t droppedEvents_ = 0;
+  std::unordered_map<std::string, TranslationUnitUsage> translationUnits_;
+};
+
+/**
+ * @brief Times the enclosing scope when the profiler is enabled
+ *
+ * Category and name must outlive the profiler, string literals in practice
+ *
+ * @class ScopedTimer
+ */
+class ScopedTimer {
+ public:
+  /**
+   * @brief Starts timing a scope
+   *
+   * @arg category
+   * @arg name
+   * @arg file header the scope works on, copied only when the profiler is enabled
+   */
+  ScopedTimer(std::string_view category, std::string_view name, const fs::path *file = nullptr)
+      : active_(Profiler::global().isEnabled()), category_(category), name_(name), file_(file) {
+    if (!active_) return;
+    if (category_ == "phase") Profiler::resetPeakMemory();
+    start_ = Profiler::Clock::now();
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  auto operator=(const ScopedTimer &) -> ScopedTimer & = delete;
+
+  /**
+   * @brief Records the scope
+   */
+  ~ScopedTimer() { stop(); }
+
+  /**
+   * @brief Records the scope now instead of at its end, later calls do nothing
+   *
+   * @return void
+   */
+  auto stop() -> void {
+    if (!active_) return;
+    active_ = false;
+    Profiler::global().record(category_, name_, file_ ? file_->string() : std::string(), start_,
+                              Profiler::Clock::now());
+  }
+
+ private:
+  bool active_;
+  std::string_view category_;
+  std::string_view name_;
+  const fs::path *file_;
+  Profiler::Clock::time_point start_;
+};
+
+/**
+ * @brief Enables the profiler for the lifetime of main, logs its summary and exports its trace when main returns
+ *
+ * @class ProfileSession
+ */
+class ProfileSession {
+ public:
+  /**
+   * @brief Constructs a ProfileSession
+   *
+   * @arg tracePath empty writes no trace
+   * @arg slowestCount number of headers listed in the summary
+   * @arg verbose If true, the profiler records and logs its summary even without a trace
+   */
+  ProfileSession(fs::path tracePath, size_t slowestCount, bool verbose);
+
+  ProfileSession(const ProfileSession &) = delete;
+  auto operator=(const ProfileSession &) -> ProfileSession & = delete;
+
+  /**
+   * @brief Logs the summary and writes the trace
+   */
+  ~ProfileSession();
+
+ private:
+  fs::path tracePath_;
+  size_t slowestCount_;
+  bool enabled_;
+};
+
+#endif /* !PROFILER_HPP_ */
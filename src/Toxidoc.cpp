@@ -1,44 +1,51 @@
 #include <cxxopts.hpp>
 #include <iostream>
+#include <set>
+#include <unordered_set>
 
+#include "Daemon/Daemon.hpp"
 #include "FilesManager/FilesManager.hpp"
 #include "ObjectsManager/ObjectsManager.hpp"
+#include "Pipeline/Pipeline.hpp"
+#include "Profiler/Profiler.hpp"
 #include "Toxiconfig.h"
 #include "Utils.hpp"
 
 static auto showCoverageBar(const std::vector<Object> &objects) -> void {
   spdlog::info("Documentation coverage per file:");
 
-  std::map<std::string, std::vector<Object>> docsByFile;
-  for (const auto &obj : objects) docsByFile[obj.getObjectPath().string()].push_back(obj);
+  // only the counts are needed, objects are neither copied nor grouped
+  struct FileCoverage {
+    size_t totalObjects = 0;
+    size_t documentedObjects = 0;
+  };
+  std::map<std::string_view, FileCoverage> coverageByFile;
   size_t allTotalObjects = 0;
   size_t allDocumentedObjects = 0;
-  size_t overallTitleOffset = 0;
+  for (const auto &obj : objects) {
+    FileCoverage &coverage = coverageByFile[obj.getObjectPathView()];
+    if (obj.getState() == ObjectState::Removed) continue;
+    coverage.totalObjects++;
+    allTotalObjects++;
+    if (obj.isValid()) {
+      coverage.documentedObjects++;
+      allDocumentedObjects++;
+    }
+  }
 
-  for (const auto &[filePath, objs] : docsByFile)
+  size_t overallTitleOffset = 0;
+  for (const auto &[filePath, coverage] : coverageByFile)
     if (filePath.length() > overallTitleOffset) overallTitleOffset = filePath.length();
 
-  for (const auto &[filePath, objs] : docsByFile) {
-    size_t totalObjects = 0;
-    size_t documentedObjects = 0;
-    for (const auto &obj : objs) {
-      if (obj.getState() == ObjectState::Removed) continue;
-      totalObjects++;
-      allTotalObjects++;
-      if (obj.isValid()) {
-        documentedObjects++;
-        allDocumentedObjects++;
-      }
-    }
-
-    auto status =
-        bk::ProgressBar(&documentedObjects, {
-                                                .total = totalObjects,
-                                                .message = fmt::format("{:<{}}", filePath, overallTitleOffset),
-                                                .style = bk::ProgressBarStyle::Rich,
-                                                .no_tty = true,
-                                                .show = true,
-                                            });
+  for (auto &[filePath, coverage] : coverageByFile) {
+    auto status = bk::ProgressBar(&coverage.documentedObjects,
+                                  {
+                                      .total = coverage.totalObjects,
+                                      .message = fmt::format("{:<{}}", filePath, overallTitleOffset),
+                                      .style = bk::ProgressBarStyle::Rich,
+                                      .no_tty = true,
+                                      .show = true,
+                                  });
     status->done();
     cleanupProgressBar();
     cleanupProgressBar();
@@ -56,6 +63,102 @@ static auto showCoverageBar(const std::vector<Object> &objects) -> void {
   cleanupProgressBar();
 }
 
+/**
+ * @brief Prints the objects whose name matches a query
+ *
+ * @arg objects
+ * @arg index names of the objects
+ * @arg pattern
+ * @arg match
+ *
+ * @return std::expected<size_t, std::string> number of objects printed, an error for an invalid regex
+ */
+static auto printMatchingObjects(const std::vector<Object> &objects, const SymbolIndex &index,
+                                 const std::string &pattern, SymbolMatch match) -> std::expected<size_t, std::string> {
+  auto matches = index.find(pattern, match);
+  if (!matches) return std::unexpected(matches.error());
+  if (matches->empty()) return 0;
+  std::unordered_set<std::string_view> matchedNames;
+  for (size_t nameIndex : matches.value()) matchedNames.insert(index.getName(nameIndex));
+  size_t foundCount = 0;
+  for (const auto &obj : objects) {
+    if (!matchedNames.contains(obj.getObjectName())) continue;
+    foundCount++;
+    std::cout << obj.getObjectAsString() << std::endl;
+  }
+  return foundCount;
+}
+
+/**
+ * @brief Shows the objects whose name matches a query, saved objects are found through the symbol index and only the
+ * headers changed since the last save are parsed
+ *
+ * @arg filesManager FilesManager with its settings loaded, the saved objects are read for the matched files only
+ * @arg objectsManager
+ * @arg pattern
+ * @arg match
+ * @arg jobs number of threads parsing the changed headers
+ * @arg usePch if true, an up to date precompiled header is used when a header has to be parsed
+ *
+ * @return int exit code
+ */
+static auto lookupObjects(FilesManager &filesManager, ObjectsManager &objectsManager, const std::string &pattern,
+                          SymbolMatch match, size_t jobs, bool usePch) -> int {
+  auto sourcesResult = filesManager.initSources();
+  if (!sourcesResult) {
+    spdlog::error("Failed to initialize FilesManager: {}", sourcesResult.error());
+    return 1;
+  }
+
+  std::vector<fs::path> staleFiles = filesManager.getStaleFiles();
+  if (!staleFiles.empty()) {
+    spdlog::info("Parsing {} source files changed since the last save...", staleFiles.size());
+    if (usePch) {
+      // a lookup writes nothing, it only reuses an up to date precompiled header
+      auto pchResult = objectsManager.preparePrecompiledHeader(filesManager.getPrecompiledHeaderPath(),
+                                                               filesManager.getPchIncludes(), true);
+      if (!pchResult) spdlog::warn("Precompiled header disabled: {}", pchResult.error());
+    }
+    std::atomic<size_t> processedFiles = 0;
+    objectsManager.processHeaderFiles(staleFiles, jobs, processedFiles, {});
+  }
+
+  const SymbolIndex &savedIndex = filesManager.loadSymbolIndex();
+  auto savedMatches = savedIndex.find(pattern, match);
+  if (!savedMatches) {
+    spdlog::error("Failed to look up '{}': {}", pattern, savedMatches.error());
+    return 1;
+  }
+
+  // saved objects of changed or vanished files are out of date, the parsed ones stand for them
+  std::unordered_set<std::string> currentFiles;
+  for (const auto &path : filesManager.getSourcePaths()) currentFiles.insert(path.string());
+  for (const auto &path : staleFiles) currentFiles.erase(path.string());
+
+  std::unordered_set<std::string_view> matchedNames;
+  std::set<std::string_view> matchedFiles;
+  for (size_t nameIndex : savedMatches.value()) {
+    matchedNames.insert(savedIndex.getName(nameIndex));
+    for (std::string_view file : savedIndex.getNameFiles(nameIndex))
+      if (currentFiles.contains(std::string(file))) matchedFiles.insert(file);
+  }
+
+  size_t foundCount = 0;
+  for (std::string_view file : matchedFiles) {
+    for (const auto &obj : filesManager.loadSavedFileObjects(fs::path(file))) {
+      if (!matchedNames.contains(obj.getObjectName())) continue;
+      foundCount++;
+      std::cout << obj.getObjectAsString() << std::endl;
+    }
+  }
+
+  const auto &parsedObjects = objectsManager.getObjectsList();
+  if (!parsedObjects.empty())
+    foundCount += printMatchingObjects(parsedObjects, SymbolIndex::build(parsedObjects), pattern, match).value_or(0);
+  spdlog::info("Found {} objects matching '{}'", foundCount, pattern);
+  return 0;
+}
+
 static auto processDocumentationStatus(const std::vector<Object> &objects, bool verbose, bool coverage) -> int {
   size_t undocumentedCount = 0;
   std::string statusReport;
@@ -94,6 +197,84 @@ static auto processDocumentationStatus(const std::vector<Object> &objects, bool
   return undocumentedCount > 0 ? 1 : 0;
 }
 
+
+/**
+ * @brief Keeps the objects up to date as headers change and answers the requests of --client runs
+ *
+ * @arg filesManager
+ * @arg objectsManager holding the objects of every source
+ * @arg jobs number of files written concurrently by a generate request
+ * @arg noSave If true, the config is not saved after a change
+ *
+ * @return int exit code
+ */
+static auto runDaemon(FilesManager &filesManager, ObjectsManager &objectsManager, size_t jobs, bool noSave) -> int {
+  Daemon daemon(filesManager, objectsManager, noSave);
+  auto runResult = daemon.run([&](const json::json &request) -> int {
+    std::string command = request.value("command", "");
+    const auto &objects = objectsManager.getObjectsList();
+    if (command == "get-object") {
+      std::string pattern = request.value("pattern", "");
+      auto match = SymbolIndex::getMatchFromString(request.value("match", "substring"));
+      if (!match) {
+        spdlog::error("Unknown match mode '{}', expected prefix, substring or regex", request.value("match", ""));
+        return 1;
+      }
+      auto foundCount = printMatchingObjects(objects, daemon.getSymbolIndex(), pattern, match.value());
+      if (!foundCount) {
+        spdlog::error("Failed to look up '{}': {}", pattern, foundCount.error());
+        return 1;
+      }
+      spdlog::info("Found {} objects matching '{}'", foundCount.value(), pattern);
+      return 0;
+    }
+    if (command == "generate") {
+      // the written headers come back through the watches and are reparsed before the next request
+      objectsManager.generateDocumentation(jobs);
+      return 0;
+    }
+    if (command == "coverage")
+      return processDocumentationStatus(objects, request.value("verbose", false), request.value("coverage", false));
+    spdlog::error("Unknown request '{}'", command);
+    return 1;
+  });
+  if (!runResult) {
+    spdlog::error("Daemon failed: {}", runResult.error());
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Sends the request described by the options to the daemon serving the config and prints its answer
+ *
+ * @arg result parsed options
+ * @arg verbose
+ * @arg coverage
+ *
+ * @return int exit code of the request
+ */
+static auto sendDaemonRequest(const cxxopts::ParseResult &result, bool verbose, bool coverage) -> int {
+  json::json request;
+  if (result.count("get-object"))
+    request = {{"command", "get-object"},
+               {"pattern", result["get-object"].as<std::string>()},
+               {"match", result["match"].as<std::string>()}};
+  else if (result["generate"].as<bool>())
+    request = {{"command", "generate"}};
+  else
+    request = {{"command", "coverage"}, {"verbose", verbose}, {"coverage", coverage}};
+
+  fs::path configPath = result.count("config") ? fs::path(result["config"].as<std::string>()) : "toxiconf.json";
+  auto response = Daemon::sendRequest(Daemon::getSocketPath(configPath), request);
+  if (!response) {
+    spdlog::error("{}", response.error());
+    return 1;
+  }
+  std::cout << response->value("output", "") << std::flush;
+  return response->value("status", 1);
+}
+
 int main(int ac, char **av) {
   cxxopts::Options options("Toxidoc", "C++ Documentation Manager");
 
@@ -104,17 +285,44 @@ int main(int ac, char **av) {
       "g,generate", "Generate beginning documentation blocks for undocumented objects",
       cxxopts::value<bool>()->default_value("false"))(
       "o,get-object", "Shows objects whose name matches the argument you provide", cxxopts::value<std::string>())(
+      "match", "How --get-object matches names, prefix, substring or regex",
+      cxxopts::value<std::string>()->default_value("substring"))(
       "x,header-extensions", "Header file extensions (comma separated)",
       cxxopts::value<std::vector<std::string>>()->default_value(".h,.hpp,.hh,.hxx,.ipp,.tpp,.inl"))(
-      "e,exclude-dirs", "Directories to exclude (comma separated)",
+      "e,exclude-dirs", "Directories or gitignore-style patterns to exclude (comma separated)",
       cxxopts::value<std::vector<std::string>>()->default_value("build,.git,third_party,external"))(
       "b,blacklist", "Words to designate names to ignore (comma separated)",
       cxxopts::value<std::vector<std::string>>()->default_value("Q_PROPERTY"))(
       "t,types", "Blacklist of object types to document (comma separated)",
       cxxopts::value<std::vector<std::string>>()->default_value(""))("type-list", "List of available object types")(
+      "full", "Ignore saved file fingerprints and parse every header again",
+      cxxopts::value<bool>()->default_value("false"))(
+      "store", "Format of the saved objects, json, binary or sharded (the config is converted on the next save)",
+      cxxopts::value<std::string>())(
+      "compact", "Write the config file without indentation", cxxopts::value<bool>()->default_value("false"))(
+      "j,jobs", "Number of worker threads used to parse headers (0 uses every available core)",
+      cxxopts::value<size_t>()->default_value("1"))(
+      "pipeline", "Overlap file discovery, parsing and merging through bounded queues",
+      cxxopts::value<bool>()->default_value("false"))(
+      "declarations-only", "Skip function bodies and tolerate incomplete translation units for a faster parse",
+      cxxopts::value<bool>()->default_value("false"))(
       "v,verbose", "Verbose *LITE* output mode", cxxopts::value<bool>()->default_value("false"))(
       "d, coverage", "Remove the progress bar for documentation coverage",
       cxxopts::value<bool>()->default_value("false"))(
+      "pch-includes", "Common includes precompiled once per run along with the module (comma separated)",
+      cxxopts::value<std::vector<std::string>>()->default_value(""))(
+      "no-pch", "Do not build or use a precompiled header for the module and common includes",
+      cxxopts::value<bool>()->default_value("false"))(
+      "compile-commands", "compile_commands.json (or its directory) giving the include paths and flags of the headers",
+      cxxopts::value<std::string>())(
+      "daemon", "Stay resident, reparse headers as they change and answer the requests of --client runs (Linux)",
+      cxxopts::value<bool>()->default_value("false"))(
+      "client", "Send the coverage, --get-object or --generate request to the daemon serving the config",
+      cxxopts::value<bool>()->default_value("false"))(
+      "profile", "Write the time and memory of each phase and header to a Chrome trace-event file (chrome://tracing, "
+      "Perfetto)",
+      cxxopts::value<std::string>())(
+      "profile-top", "Number of slowest headers listed by --profile", cxxopts::value<size_t>()->default_value("10"))(
       "mod",
       "add module name for clang parsing (e.g. --mod path/to/modules/qt_override.h in this case we use a header to "
       "override QT macros, refers to mods folder to list all modules ; don't create your own module, the code is not "
@@ -146,44 +354,147 @@ int main(int ac, char **av) {
   bool coverageRequested = result["coverage"].as<bool>() == false;
   bool verboseRequested = result["verbose"].as<bool>() == false;
 
-  FilesManager filesManager(
-      result.count("config") ? fs::path(result["config"].as<std::string>()) : fs::path(), result["no-save"].as<bool>(),
-      result.count("mod") ? fs::path(result["mod"].as<std::string>()) : fs::path(),
-      result.count("source-paths") ? result["source-paths"].as<std::vector<std::string>>() : std::vector<std::string>{},
-      result["header-extensions"].as<std::vector<std::string>>(), result["exclude-dirs"].as<std::vector<std::string>>(),
-      result["blacklist"].as<std::vector<std::string>>(), result["types"].as<std::vector<std::string>>(),
-      result["recursive"].as<bool>());
+  // a client only needs the socket, nothing is loaded
+  if (result["client"].as<bool>()) return sendDaemonRequest(result, verboseRequested, coverageRequested);
+
+  // scopes are only recorded while a session is open, the summary is logged and the trace written when main returns
+  ProfileSession profileSession(result.count("profile") ? fs::path(result["profile"].as<std::string>()) : fs::path(),
+                                result["profile-top"].as<size_t>(), result["verbose"].as<bool>());
 
-  auto initResult = filesManager.init();
+  // a lookup reads the saved objects of the matched files only, a full rescan that generates never reads them
+  bool lookupOnly = result.count("get-object") && !result["daemon"].as<bool>();
+  // the daemon saves after every change, the saved objects give the states of the first save
+  bool savedObjectsNeeded = !lookupOnly && (result["daemon"].as<bool>() || !result["full"].as<bool>() ||
+                                            (!result.count("get-object") && !result["generate"].as<bool>()));
+
+  FilesManagerOptions filesOptions;
+  if (result.count("config")) filesOptions.configPath = result["config"].as<std::string>();
+  filesOptions.noSave = result["no-save"].as<bool>();
+  if (result.count("mod")) filesOptions.modPath = result["mod"].as<std::string>();
+  if (result.count("source-paths")) filesOptions.paths = result["source-paths"].as<std::vector<std::string>>();
+  filesOptions.headerExtensions = result["header-extensions"].as<std::vector<std::string>>();
+  filesOptions.excludeDirs = result["exclude-dirs"].as<std::vector<std::string>>();
+  filesOptions.wordsBlacklist = result["blacklist"].as<std::vector<std::string>>();
+  filesOptions.typesBlacklist = result["types"].as<std::vector<std::string>>();
+  filesOptions.pchIncludes = result["pch-includes"].as<std::vector<std::string>>();
+  if (result.count("compile-commands")) filesOptions.compileCommands = result["compile-commands"].as<std::string>();
+  filesOptions.recursive = result["recursive"].as<bool>();
+  filesOptions.fullScan = result["full"].as<bool>();
+  filesOptions.declarationsOnly = result["declarations-only"].as<bool>();
+  if (result.count("store")) filesOptions.storeFormat = result["store"].as<std::string>();
+  filesOptions.compactConfig = result["compact"].as<bool>();
+  filesOptions.loadObjects = savedObjectsNeeded;
+  FilesManager filesManager(std::move(filesOptions));
+
+  ScopedTimer settingsTimer("phase", "settings");
+  auto initResult = filesManager.initSettings();
+  settingsTimer.stop();
   if (!initResult) {
     spdlog::error("Failed to initialize FilesManager: {}", initResult.error());
     return 1;
   }
 
+  ParseProfile parseProfile =
+      result["declarations-only"].as<bool>() ? ParseProfile::DeclarationsOnly : ParseProfile::Full;
   ObjectsManager objectsManager(filesManager.getWordsBlacklist(), filesManager.getTypesBlacklist(),
-                                filesManager.getModulePath());
-
-  spdlog::info("Processing {} source files...", filesManager.getSourcePaths().size());
-  size_t processedFiles = 0;
-  auto status = bk::ProgressBar(&processedFiles, {
-                                                     .total = filesManager.getSourcePaths().size(),
-                                                     .message = "Processing objects in files...",
-                                                     .style = bk::ProgressBarStyle::Rich,
-                                                     .interval = 1.0,
-                                                     .no_tty = true,
-                                                 });
-
-  std::vector<fs::path> sourcePaths = filesManager.getSourcePaths();
-  for (const auto &path : sourcePaths) {
-    processedFiles++;
-    auto processResult = objectsManager.processHeaderFile(path);
-    if (!processResult) {
-      spdlog::error("Error processing file {}: {}", path.string(), processResult.error());
-      continue;
+                                filesManager.getModulePath(), parseProfile);
+  objectsManager.setCompilationDatabase(filesManager.getCompilationDatabase());
+
+  if (result.count("get-object") && !result["daemon"].as<bool>()) {
+    auto match = SymbolIndex::getMatchFromString(result["match"].as<std::string>());
+    if (!match) {
+      spdlog::error("Unknown match mode '{}', expected prefix, substring or regex", result["match"].as<std::string>());
+      return 1;
     }
+    ScopedTimer lookupTimer("phase", "lookup");
+    return lookupObjects(filesManager, objectsManager, result["get-object"].as<std::string>(), match.value(),
+                         result["jobs"].as<size_t>(), !result["no-pch"].as<bool>());
+  }
+
+  if (!result["no-pch"].as<bool>()) {
+    ScopedTimer pchTimer("phase", "pch");
+    // a run that does not save writes no precompiled header either
+    auto pchResult = objectsManager.preparePrecompiledHeader(
+        filesManager.getPrecompiledHeaderPath(), filesManager.getPchIncludes(), result["no-save"].as<bool>());
+    if (!pchResult) spdlog::warn("Precompiled header disabled: {}", pchResult.error());
+  }
+
+  std::atomic<size_t> processedFiles = 0;
+  std::optional<std::vector<Object>> pipelinedObjects;
+  if (result["pipeline"].as<bool>()) {
+    spdlog::info("Processing source files as they are discovered...");
+    auto status = bk::Counter(&processedFiles, {
+                                                   .message = "Processing objects in files...",
+                                                   .speed = 1,
+                                                   .speed_unit = "files/s",
+                                                   .interval = 1.0,
+                                                   .no_tty = true,
+                                               });
+    Pipeline pipeline(filesManager, objectsManager, result["jobs"].as<size_t>());
+    ScopedTimer pipelineTimer("phase", "pipeline");
+    auto pipelineResult = pipeline.run(processedFiles);
+    pipelineTimer.stop();
+    status->done();
+    cleanupProgressBar();
+    if (!pipelineResult) {
+      spdlog::error("Failed to initialize FilesManager: {}", pipelineResult.error());
+      return 1;
+    }
+    if (pipelineResult->cachedFiles > 0)
+      spdlog::info("Reused saved objects of {} unchanged files", pipelineResult->cachedFiles);
+    for (const auto &path : pipelineResult->failedFiles) filesManager.invalidateFingerprint(path);
+    if (pipelineResult->merged) pipelinedObjects = std::move(pipelineResult->mergedObjects);
+  } else {
+    ScopedTimer sourcesTimer("phase", "sources");
+    auto sourcesResult = filesManager.initSources();
+    sourcesTimer.stop();
+    if (!sourcesResult) {
+      spdlog::error("Failed to initialize FilesManager: {}", sourcesResult.error());
+      return 1;
+    }
+
+    spdlog::info("Processing {} source files...", filesManager.getSourcePaths().size());
+    auto status = bk::ProgressBar(&processedFiles, {
+                                                       .total = filesManager.getSourcePaths().size(),
+                                                       .message = "Processing objects in files...",
+                                                       .style = bk::ProgressBarStyle::Rich,
+                                                       .interval = 1.0,
+                                                       .no_tty = true,
+                                                   });
+
+    auto unchangedObjects = filesManager.getUnchangedFilesObjects();
+    if (!unchangedObjects.empty())
+      spdlog::info("Reusing saved objects of {} unchanged files", unchangedObjects.size());
+    ScopedTimer parseTimer("phase", "parse");
+    auto failedFiles = objectsManager.processHeaderFiles(filesManager.getSourcePaths(), result["jobs"].as<size_t>(),
+                                                         processedFiles, std::move(unchangedObjects));
+    parseTimer.stop();
+    for (const auto &path : failedFiles) filesManager.invalidateFingerprint(path);
+    status->done();
+    cleanupProgressBar();
+  }
+
+  if (result["verbose"].as<bool>() && objectsManager.getVisitedCursorsCount() > 0) {
+    double visitedCursors = static_cast<double>(objectsManager.getVisitedCursorsCount());
+    spdlog::info("Visited {} cursors, {:.2f} arena allocations and {:.4f} heap blocks per cursor",
+                 objectsManager.getVisitedCursorsCount(), objectsManager.getArenaAllocationsCount() / visitedCursors,
+                 objectsManager.getArenaBlocksCount() / visitedCursors);
+  }
+  if (result["verbose"].as<bool>()) {
+    const auto &parsedObjects = objectsManager.getObjectsList();
+    const auto &savedObjects = filesManager.getSavedObjects();
+    double objectsMegabytes =
+        static_cast<double>((parsedObjects.capacity() + savedObjects.capacity()) * sizeof(Object)) / (1024.0 * 1024.0);
+    spdlog::info("Holding {} parsed and {} saved objects in {:.1f} MB, {} interned strings in {:.1f} MB",
+                 parsedObjects.size(), savedObjects.size(), objectsMegabytes, StringPool::global().getStringsCount(),
+                 static_cast<double>(StringPool::global().getArenaBytes()) / (1024.0 * 1024.0));
+  }
+
+  if (result["daemon"].as<bool>()) {
+    // the daemon merges the parsed objects file by file, a merge kept for the save would hold on to freed strings
+    pipelinedObjects.reset();
+    return runDaemon(filesManager, objectsManager, result["jobs"].as<size_t>(), result["no-save"].as<bool>());
   }
-  status->done();
-  cleanupProgressBar();
 
   auto lastUpdateTime = filesManager.getLastSaveTime();
   if (lastUpdateTime == std::chrono::system_clock::time_point{}) lastUpdateTime = std::chrono::system_clock::now();
@@ -192,26 +503,15 @@ int main(int ac, char **av) {
   const auto &parsedObjects = objectsManager.getObjectsList();
   const auto &savedObjects = filesManager.getSavedObjects();
 
-  if (result.count("get-object")) {
-    const std::string &objName = result["get-object"].as<std::string>();
-    size_t foundCount = 0;
-    for (const auto &obj : parsedObjects) {
-      if (obj.getObjectName().contains(objName)) {
-        foundCount++;
-        std::cout << obj.getObjectAsString() << std::endl;
-      }
-    }
-    spdlog::info("Found {} objects matching '{}'", foundCount, objName);
-    return 0;
-  }
-
   if (result["generate"].as<bool>()) {
-    objectsManager.generateDocumentation();
+    ScopedTimer generateTimer("phase", "generate");
+    objectsManager.generateDocumentation(result["jobs"].as<size_t>());
     return 0;
   }
 
-  if (savedObjects.empty()) {
+  if (savedObjects.empty() && !pipelinedObjects) {
     if (!result["no-save"].as<bool>()) {
+      ScopedTimer saveTimer("phase", "save");
       auto saveResult = filesManager.saveConfig(parsedObjects);
       if (!saveResult) {
         spdlog::error("Failed to save config: {}", saveResult.error());
@@ -222,38 +522,13 @@ int main(int ac, char **av) {
     return processDocumentationStatus(parsedObjects, verboseRequested, coverageRequested);
   }
 
-  std::vector<Object> mergedObjects;
-  for (const auto &savedObj : savedObjects) {
-    bool found = false;
-    for (const auto &parsedObj : parsedObjects) {
-      if (savedObj == parsedObj) {
-        found = true;
-        break;
-      }
-    }
-    if (!found) {
-      mergedObjects.push_back(savedObj);
-      mergedObjects.back().setState(ObjectState::Removed);
-      continue;
-    }
-  }
-  for (const auto &parsedObj : parsedObjects) {
-    bool found = false;
-    for (const auto &savedObj : savedObjects) {
-      if (parsedObj == savedObj) {
-        found = true;
-        Object updatedObj = savedObj;
-        updatedObj.updateObject(parsedObj);
-        mergedObjects.push_back(updatedObj);
-        break;
-      }
-    }
-    if (!found) {
-      mergedObjects.push_back(parsedObj);
-      mergedObjects.back().setState(ObjectState::Added);
-    }
-  }
+  // the pipeline already merged each file as it was parsed
+  ScopedTimer mergeTimer("phase", "merge");
+  std::vector<Object> mergedObjects = pipelinedObjects ? std::move(pipelinedObjects.value())
+                                                       : ObjectsManager::mergeObjects(savedObjects, parsedObjects);
+  mergeTimer.stop();
   if (!result["no-save"].as<bool>()) {
+    ScopedTimer saveTimer("phase", "save");
     auto saveResult = filesManager.saveConfig(mergedObjects);
     if (!saveResult) {
       spdlog::error("Failed to save config: {}", saveResult.error());
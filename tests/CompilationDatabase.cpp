@@ -0,0 +1,202 @@
+#include "FilesManager/CompilationDatabase.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Tests.hpp"
+
+/**
+ * @brief Command line and the arguments it splits into
+ *
+ * @struct SplitCommandCase
+ */
+struct SplitCommandCase {
+  std::string command;
+  std::vector<std::string> arguments;
+};
+
+/**
+ * @brief Invocation, the directory of its entry and the flags kept from it
+ *
+ * @struct ExtractFlagsCase
+ */
+struct ExtractFlagsCase {
+  std::vector<std::string> arguments;
+  fs::path directory;
+  std::vector<std::string> flags;
+};
+
+/**
+ * @brief Header and the defines of the flag set it takes, empty when the database does not cover it
+ *
+ * @struct FlagSetCase
+ */
+struct FlagSetCase {
+  fs::path headerPath;
+  std::optional<std::vector<std::string>> flags;
+};
+
+/**
+ * @brief Joins arguments for a log line, each one quoted so empty arguments and spaces stay visible
+ *
+ * @arg arguments
+ *
+ * @return std::string
+ */
+static auto quoteArguments(const std::vector<std::string> &arguments) -> std::string {
+  std::string quoted;
+  for (const auto &argument : arguments) quoted += (quoted.empty() ? "\"" : " \"") + argument + "\"";
+  return quoted;
+}
+
+/**
+ * @brief Checks splitCommand on quotes, escapes and whitespace
+ *
+ * @return size_t number of failed cases
+ */
+static auto checkSplitCommand() -> size_t {
+  const std::vector<SplitCommandCase> cases = {
+      {"c++ -DA=1  -Iinc -c a.cpp", {"c++", "-DA=1", "-Iinc", "-c", "a.cpp"}},
+      {" \tc++\n-Iinc \r\n", {"c++", "-Iinc"}},
+      {"", {}},
+      // double quotes group spaces and only unescape quotes and backslashes
+      {R"(cc "-DMSG=\"hi there\"" x)", {"cc", R"(-DMSG="hi there")", "x"}},
+      {R"(cc "a\\b" "a\nb")", {"cc", R"(a\b)", R"(a\nb)"}},
+      {R"(cc -I"my dir"/inc)", {"cc", "-Imy dir/inc"}},
+      // single quotes keep everything as it is
+      {R"(cc '-DA=$b "c"\' d)", {"cc", R"(-DA=$b "c"\)", "d"}},
+      // empty quotes are still an argument
+      {R"(cc "" '' x)", {"cc", "", "", "x"}},
+      // a backslash outside quotes escapes any character
+      {R"(cc a\ b \"c\")", {"cc", "a b", R"("c")"}},
+  };
+
+  size_t failedCount = 0;
+  for (const auto &testCase : cases) {
+    std::vector<std::string> arguments = CompilationDatabase::splitCommand(testCase.command);
+    if (arguments == testCase.arguments) continue;
+    spdlog::error("splitCommand('{}') gave {}, expected {}", testCase.command, quoteArguments(arguments),
+                  quoteArguments(testCase.arguments));
+    failedCount++;
+  }
+  return failedCount;
+}
+
+/**
+ * @brief Checks extractFlags on joined and separate values, relative paths and forced includes
+ *
+ * @arg root existing directory holding present.h
+ *
+ * @return size_t number of failed cases
+ */
+static auto checkExtractFlags(const fs::path &root) -> size_t {
+  const fs::path work = "/work";
+  const std::string present = (root / "present.h").string();
+  const std::vector<ExtractFlagsCase> cases = {
+      // joined and separate include directories, resolved against the entry directory
+      {{"cc", "-Iinclude", "-I", "include"}, work, {"-I", "/work/include", "-I", "/work/include"}},
+      {{"cc", "-isystem/usr/inc", "-isystem", "sys"}, work, {"-isystem", "/usr/inc", "-isystem", "/work/sys"}},
+      {{"cc", "-iquote", "q", "-idirafterlast"}, work, {"-iquote", "/work/q", "-idirafter", "/work/last"}},
+      {{"cc", "-I../up/./inc"}, work, {"-I", "/up/inc"}},
+      {{"cc", "--sysroot=root", "--sysroot", "/abs"}, work, {"--sysroot", "/work/root", "--sysroot", "/abs"}},
+      // a flag missing its value is dropped
+      {{"cc", "-I"}, work, {}},
+      // the first argument is the compiler, whatever it looks like
+      {{"-Iinc", "-Iother"}, work, {"-I", "/work/other"}},
+      // macros and target are kept, the rest of the invocation is not
+      {{"cc", "-DX=1", "-D", "Y", "-UZ", "-target", "x86_64-linux-gnu"},
+       work,
+       {"-DX=1", "-D", "Y", "-UZ", "-target", "x86_64-linux-gnu"}},
+      {{"cc", "-std=c++20", "-O2", "-Wall", "-o", "a.o", "-c", "a.cpp", "-nostdinc"},
+       work,
+       {"-std=c++20", "-nostdinc"}},
+      // a forced include is resolved only when it exists next to the entry, else left to the search path
+      {{"cc", "-include", "present.h"}, root, {"-include", present}},
+      {{"cc", "-include", "missing.h", "-imacros", "macros.h"},
+       root,
+       {"-include", "missing.h", "-imacros", "macros.h"}},
+  };
+
+  size_t failedCount = 0;
+  for (const auto &testCase : cases) {
+    std::vector<std::string> flags = CompilationDatabase::extractFlags(testCase.arguments, testCase.directory);
+    if (flags == testCase.flags) continue;
+    spdlog::error("extractFlags({}) in {} gave {}, expected {}", quoteArguments(testCase.arguments),
+                  testCase.directory.string(), quoteArguments(flags), quoteArguments(testCase.flags));
+    failedCount++;
+  }
+  return failedCount;
+}
+
+/**
+ * @brief Checks the flag set picked for headers listed, next to or away from the entries of a database
+ *
+ * @arg root existing directory the database is written to
+ *
+ * @return size_t number of failed cases
+ */
+static auto checkFlagSetIndex(const fs::path &root) -> size_t {
+  const fs::path project = root / "project";
+  {
+    std::ofstream databaseFile(root / "compile_commands.json");
+    databaseFile << R"([
+      {"directory": ")" << project.string() << R"(", "file": "src/a/foo.cpp", "command": "cc -DFOO -c src/a/foo.cpp"},
+      {"directory": ")" << project.string() << R"(", "file": "src/a/bar.cpp", "arguments": ["cc", "-DBAR"]},
+      {"directory": ")" << project.string() << R"(", "file": "src/b/baz.cpp", "arguments": ["cc", "-DBAZ"]},
+      {"directory": ")" << project.string() << R"(", "file": "src/b/baz.hpp", "arguments": ["cc", "-DHEADER"]}
+    ])";
+  }
+  auto database = CompilationDatabase::load(root);
+  if (!database) {
+    spdlog::error("CompilationDatabase::load: {}", database.error());
+    return 1;
+  }
+
+  using Flags = std::vector<std::string>;
+  const std::vector<FlagSetCase> cases = {
+      // a listed file takes its own entry
+      {project / "src/a/foo.cpp", Flags{"-DFOO"}},
+      {project / "src/b/baz.hpp", Flags{"-DHEADER"}},
+      // a header takes the translation unit of the same stem, else the first entry by file name
+      {project / "src/a/foo.hpp", Flags{"-DFOO"}},
+      {project / "src/a/./bar.h", Flags{"-DBAR"}},
+      {project / "src/a/other.hpp", Flags{"-DBAR"}},
+      // a header below an entry directory takes the nearest one
+      {project / "src/b/inner/baz.hpp", Flags{"-DBAZ"}},
+      // a header between entry directories takes the first one below the common root
+      {project / "src/include/qux.hpp", Flags{"-DBAR"}},
+      // a header outside the deepest directory holding every entry is not covered
+      {project / "include/foo.hpp", std::nullopt},
+      {root / "foo.hpp", std::nullopt},
+  };
+
+  size_t failedCount = 0;
+  for (const auto &testCase : cases) {
+    std::optional<size_t> index = database->getFlagSetIndex(testCase.headerPath);
+    std::optional<Flags> flags;
+    if (index) flags = database->getFlagSets()[*index];
+    if (flags == testCase.flags) continue;
+    spdlog::error("getFlagSetIndex({}) took {}, expected {}", testCase.headerPath.string(),
+                  flags ? quoteArguments(*flags) : "no flag set",
+                  testCase.flags ? quoteArguments(*testCase.flags) : "no flag set");
+    failedCount++;
+  }
+  return failedCount;
+}
+
+auto testCompilationDatabase() -> int {
+  const fs::path root = fs::temp_directory_path() / "toxidoc_tests_compilation_database";
+  fs::remove_all(root);
+  fs::create_directories(root);
+  std::ofstream(root / "present.h") << "#define PRESENT\n";
+
+  size_t failedCount = checkSplitCommand() + checkExtractFlags(root) + checkFlagSetIndex(root);
+  fs::remove_all(root);
+  if (failedCount > 0) return 1;
+  spdlog::info("CompilationDatabase matched every case");
+  return 0;
+}
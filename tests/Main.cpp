@@ -0,0 +1,30 @@
+#include <spdlog/spdlog.h>
+
+#include <map>
+#include <string>
+
+#include "Tests.hpp"
+
+/**
+ * @brief Runs the test named by the first argument, or every test without argument
+ */
+int main(int argc, char **argv) {
+  const std::map<std::string, int (*)()> tests = {
+      {"compilation_database", testCompilationDatabase},
+      {"merge_objects", testMergeObjects},
+      {"path_filter", testPathFilter},
+      {"symbol_index", testSymbolIndex},
+  };
+  if (argc > 1) {
+    auto it = tests.find(argv[1]);
+    if (it == tests.end()) {
+      spdlog::error("Unknown test '{}'", argv[1]);
+      return 1;
+    }
+    return it->second();
+  }
+  int status = 0;
+  for (const auto &[name, test] : tests)
+    if (test() != 0) status = 1;
+  return status;
+}
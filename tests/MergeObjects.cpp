@@ -0,0 +1,160 @@
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ObjectsManager/ObjectsManager.hpp"
+#include "Tests.hpp"
+
+/**
+ * @brief Merges saved and parsed objects by comparing every pair, the merge mergeObjects replaced
+ *
+ * @arg savedObjects
+ * @arg parsedObjects
+ *
+ * @return std::vector<Object>
+ */
+static auto mergeObjectsNested(const std::vector<Object> &savedObjects, const std::vector<Object> &parsedObjects)
+    -> std::vector<Object> {
+  std::vector<Object> mergedObjects;
+  for (const auto &savedObj : savedObjects) {
+    bool found = false;
+    for (const auto &parsedObj : parsedObjects) {
+      if (savedObj == parsedObj) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      mergedObjects.push_back(savedObj);
+      mergedObjects.back().setState(ObjectState::Removed);
+    }
+  }
+  for (const auto &parsedObj : parsedObjects) {
+    bool found = false;
+    for (const auto &savedObj : savedObjects) {
+      if (parsedObj == savedObj) {
+        found = true;
+        Object updatedObj = savedObj;
+        updatedObj.updateObject(parsedObj);
+        mergedObjects.push_back(updatedObj);
+        break;
+      }
+    }
+    if (!found) {
+      mergedObjects.push_back(parsedObj);
+      mergedObjects.back().setState(ObjectState::Added);
+    }
+  }
+  return mergedObjects;
+}
+
+/**
+ * @brief Builds an object from a few random choices, the small pools make identities collide often
+ *
+ * @arg random
+ *
+ * @return Object
+ */
+static auto makeRandomObject(std::mt19937 &random) -> Object {
+  static const std::array<std::string_view, 3> paths = {"a.hpp", "b.hpp", "dir/c.hpp"};
+  static const std::array<std::string_view, 4> names = {"foo", "bar", "Baz", "operator="};
+  static const std::array<std::string_view, 2> scopes = {"", "ns::Klass"};
+  static const std::array<ObjectType, 3> types = {ObjectType::Function, ObjectType::Method, ObjectType::Class};
+  static const std::array<std::string_view, 2> returnTypes = {"void", "int"};
+  static const std::array<std::string_view, 3> comments = {"", "/// @brief first", "/// @brief second"};
+  static const std::array<std::string_view, 2> argumentNames = {"int", "const std::string &"};
+
+  auto pick = [&random](const auto &pool) { return pool[random() % pool.size()]; };
+  std::vector<std::string_view> arguments;
+  for (size_t i = random() % 3; i > 0; --i) arguments.push_back(pick(argumentNames));
+  uint32_t line = random() % 50 + 1;
+  std::string_view comment = pick(comments);
+  Object obj(pick(paths), pick(names), pick(scopes), pick(types), line, 1, line + random() % 5, 2, comment,
+             comment.empty() ? "" : comment.substr(11), arguments, pick(returnTypes), ObjectState::Unchanged);
+  obj.setOverloadIndex(random() % 2);
+  return obj;
+}
+
+/**
+ * @brief Copies an object with new positions, comment and arguments, keeping the fields of its identity
+ *
+ * @arg obj
+ * @arg random
+ *
+ * @return Object
+ */
+static auto modifyObject(const Object &obj, std::mt19937 &random) -> Object {
+  Object other = makeRandomObject(random);
+  Object modified(obj.getObjectPathView(), obj.getObjectName(), obj.getObjectScope(), obj.getObjectType(),
+                  static_cast<uint32_t>(other.getStartLine()), static_cast<uint32_t>(other.getStartColumn()),
+                  static_cast<uint32_t>(other.getEndLine()), static_cast<uint32_t>(other.getEndColumn()),
+                  other.getRawComment(), other.getDebrief(), other.getArguments(), obj.getReturnType(),
+                  ObjectState::Unchanged);
+  modified.setOverloadIndex(obj.getOverloadIndex());
+  return modified;
+}
+
+/**
+ * @brief Tells if two merges gave the same objects with the same states in the same order
+ *
+ * @arg expected
+ * @arg actual
+ *
+ * @return bool
+ */
+static auto isSameMerge(const std::vector<Object> &expected, const std::vector<Object> &actual) -> bool {
+  if (expected.size() != actual.size()) return false;
+  for (size_t i = 0; i < expected.size(); ++i) {
+    if (expected[i].getState() != actual[i].getState()) return false;
+    if (expected[i].getObjectAsJSON() != actual[i].getObjectAsJSON()) return false;
+  }
+  return true;
+}
+
+auto testMergeObjects() -> int {
+  std::mt19937 random(0x70c1d0c);
+  constexpr size_t rounds = 2000;
+
+  for (size_t round = 0; round < rounds; ++round) {
+    std::vector<Object> savedObjects;
+    for (size_t i = random() % 24; i > 0; --i) {
+      savedObjects.push_back(makeRandomObject(random));
+      // saved states other than Unchanged must survive the merge as they are
+      if (random() % 4 == 0) savedObjects.back().setState(ObjectState::Modified);
+      if (random() % 6 == 0) savedObjects.push_back(savedObjects.back());
+    }
+
+    std::vector<Object> parsedObjects;
+    for (const auto &savedObj : savedObjects) {
+      switch (random() % 4) {
+        case 0:
+          break;
+        case 1:
+          parsedObjects.push_back(modifyObject(savedObj, random));
+          break;
+        default:
+          parsedObjects.push_back(savedObj);
+          parsedObjects.back().setState(ObjectState::Unchanged);
+      }
+      if (random() % 8 == 0) parsedObjects.push_back(makeRandomObject(random));
+    }
+    // a header parsed twice gives the same object twice
+    if (!parsedObjects.empty() && random() % 5 == 0)
+      parsedObjects.push_back(parsedObjects[random() % parsedObjects.size()]);
+    std::shuffle(parsedObjects.begin(), parsedObjects.end(), random);
+
+    auto expected = mergeObjectsNested(savedObjects, parsedObjects);
+    auto actual = ObjectsManager::mergeObjects(savedObjects, parsedObjects);
+    if (!isSameMerge(expected, actual)) {
+      spdlog::error("mergeObjects differs from the nested merge on round {} ({} saved, {} parsed objects)", round,
+                    savedObjects.size(), parsedObjects.size());
+      return 1;
+    }
+  }
+  spdlog::info("mergeObjects matched the nested merge on {} random rounds", rounds);
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include "FilesManager/PathFilter.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Tests.hpp"
+
+/**
+ * @brief Patterns, an entry checked against them and the expected outcome
+ *
+ * @struct PathFilterCase
+ */
+struct PathFilterCase {
+  std::vector<std::string> patterns;
+  std::string_view relativePath;
+  bool isDirectory;
+  bool excluded;
+};
+
+auto testPathFilter() -> int {
+  const std::vector<PathFilterCase> cases = {
+      // a bare name matches the entry at any depth, only by its own name
+      {{"build"}, "build", true, true},
+      {{"build"}, "src/build", true, true},
+      {{"build"}, "src/build.hpp", false, false},
+      {{"*.gen.hpp"}, "src/api/types.gen.hpp", false, true},
+      {{"*.gen.hpp"}, "src/api/types.hpp", false, false},
+      // a slash anchors the pattern to the walk root
+      {{"src/third_party"}, "src/third_party", true, true},
+      {{"src/third_party"}, "lib/src/third_party", true, false},
+      {{"/generated"}, "generated", true, true},
+      {{"/generated"}, "src/generated", true, false},
+      // "**" absorbs any number of components, none included
+      {{"src/**/internal"}, "src/internal", true, true},
+      {{"src/**/internal"}, "src/a/b/internal", true, true},
+      {{"src/**/internal"}, "lib/a/internal", true, false},
+      {{"**/gen"}, "a/b/gen", true, true},
+      {{"**/gen"}, "gen", true, true},
+      {{"src/**"}, "src/a/b.hpp", false, true},
+      // a negation re-includes what an earlier pattern excluded, the last matching pattern wins
+      {{"*.hpp", "!keep.hpp"}, "src/keep.hpp", false, false},
+      {{"*.hpp", "!keep.hpp"}, "src/drop.hpp", false, true},
+      {{"!keep.hpp", "*.hpp"}, "src/keep.hpp", false, true},
+      {{"vendor", "!vendor", "vendor"}, "vendor", true, true},
+      // a trailing slash restricts the pattern to directories
+      {{"cache/"}, "cache", true, true},
+      {{"cache/"}, "cache", false, false},
+      {{"docs/api/"}, "docs/api", false, false},
+      // character classes, ranges and their negation
+      {{"v[0-9]"}, "v7", true, true},
+      {{"v[0-9]"}, "vx", true, false},
+      {{"v[!0-9]"}, "vx", true, true},
+      {{"v[^0-9]"}, "v7", true, false},
+      {{"[]]x"}, "]x", false, true},
+      {{"file?.hpp"}, "file1.hpp", false, true},
+      {{"file?.hpp"}, "file.hpp", false, false},
+      // an unterminated class is a literal bracket
+      {{"a[b"}, "a[b", false, true},
+      {{"a[b"}, "ab", false, false},
+      {{"a[b"}, "a[c", false, false},
+      // comments, empty patterns and empty paths exclude nothing
+      {{"# build", ""}, "build", true, false},
+      {{"build"}, "", true, false},
+  };
+
+  size_t failedCount = 0;
+  for (const auto &testCase : cases) {
+    PathFilter filter(testCase.patterns);
+    bool excluded = filter.isExcluded(testCase.relativePath, testCase.isDirectory);
+    if (excluded == testCase.excluded) continue;
+    std::string patterns;
+    for (const auto &pattern : testCase.patterns) patterns += (patterns.empty() ? "\"" : ", \"") + pattern + "\"";
+    spdlog::error("PathFilter({}) {} '{}' as a {}, expected {}", patterns,
+                  excluded ? "excluded" : "kept", testCase.relativePath, testCase.isDirectory ? "directory" : "file",
+                  testCase.excluded ? "excluded" : "kept");
+    failedCount++;
+  }
+  if (failedCount > 0) return 1;
+  spdlog::info("PathFilter matched {} cases", cases.size());
+  return 0;
+}
@@ -0,0 +1,233 @@
+#include "FilesManager/SymbolIndex.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FilesManager/ObjectStore.hpp"
+#include "Tests.hpp"
+
+/**
+ * @brief Query and the names it must find
+ *
+ * @struct SymbolQueryCase
+ */
+struct SymbolQueryCase {
+  std::string_view pattern;
+  SymbolMatch match;
+  std::vector<std::string_view> names;
+};
+
+/**
+ * @brief Builds an object declared at a line of a file
+ *
+ * @arg filePath
+ * @arg name
+ * @arg line
+ * @arg state
+ *
+ * @return Object
+ */
+static auto makeObject(std::string_view filePath, std::string_view name, uint32_t line,
+                       ObjectState state = ObjectState::Unchanged) -> Object {
+  static const std::vector<std::string_view> arguments = {"int", "const std::string &"};
+  return Object(filePath, name, "ns", ObjectType::Function, line, 1, line + 2, 2, "/// @brief doc", "doc", arguments,
+                "void", state);
+}
+
+/**
+ * @brief Writes raw bytes over a file
+ *
+ * @arg path
+ * @arg data
+ *
+ * @return void
+ */
+static auto writeBytes(const fs::path &path, std::string_view data) -> void {
+  std::ofstream(path, std::ios::binary | std::ios::trunc).write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+/**
+ * @brief Checks the names found by queries on an index, "abdc" shares every trigram with "abdxbdc" without being in it
+ *
+ * @arg index
+ *
+ * @return size_t number of failed cases
+ */
+static auto checkQueries(const SymbolIndex &index) -> size_t {
+  const std::vector<SymbolQueryCase> cases = {
+      {"abd", SymbolMatch::Prefix, {"abdcz", "abdxbdc"}},
+      {"", SymbolMatch::Prefix, {"abdcz", "abdxbdc", "getValue", "setValue", "value"}},
+      {"abdc", SymbolMatch::Substring, {"abdcz"}},
+      {"bdc", SymbolMatch::Substring, {"abdcz", "abdxbdc"}},
+      {"Value", SymbolMatch::Substring, {"getValue", "setValue"}},
+      {"alu", SymbolMatch::Substring, {"getValue", "setValue", "value"}},
+      {"lu", SymbolMatch::Substring, {"getValue", "setValue", "value"}},
+      {"xyz", SymbolMatch::Substring, {}},
+      // the removed object is not indexed
+      {"removed", SymbolMatch::Substring, {}},
+      {"^[gs]et", SymbolMatch::Regex, {"getValue", "setValue"}},
+  };
+
+  size_t failedCount = 0;
+  for (const auto &testCase : cases) {
+    auto found = index.find(testCase.pattern, testCase.match);
+    std::vector<std::string_view> names;
+    if (found)
+      for (size_t nameIndex : *found) names.push_back(index.getName(nameIndex));
+    if (names == testCase.names) continue;
+    std::string foundNames;
+    for (std::string_view name : names) foundNames += (foundNames.empty() ? "" : ", ") + std::string(name);
+    spdlog::error("SymbolIndex {} query '{}' found [{}]", SymbolMatchStringMap.at(testCase.match), testCase.pattern,
+                  foundNames);
+    failedCount++;
+  }
+  return failedCount;
+}
+
+/**
+ * @brief Checks that loading the objects of each file through the index gives back the saved objects
+ *
+ * @arg index
+ * @arg storePath
+ * @arg objects saved objects
+ *
+ * @return size_t number of failed cases
+ */
+static auto checkFileSpans(const SymbolIndex &index, const fs::path &storePath, const std::vector<Object> &objects)
+    -> size_t {
+  size_t failedCount = 0;
+  for (std::string_view file : {"a.hpp", "dir/b.hpp"}) {
+    std::vector<Object> expected;
+    for (const auto &obj : objects)
+      if (obj.getObjectPathView() == file && obj.getState() != ObjectState::Removed) expected.push_back(obj);
+
+    auto loaded = ObjectStore::loadSpans(storePath, index.getFileSpans(file));
+    bool same = loaded && loaded->size() == expected.size();
+    for (size_t i = 0; same && i < expected.size(); ++i)
+      same = (*loaded)[i].getObjectAsJSON() == expected[i].getObjectAsJSON();
+    if (same) continue;
+    spdlog::error("ObjectStore::loadSpans did not give back the objects of {}: {}", file,
+                  loaded ? std::to_string(loaded->size()) + " objects" : loaded.error());
+    failedCount++;
+  }
+  if (!index.getFileSpans("unknown.hpp").empty()) {
+    spdlog::error("SymbolIndex has spans for a file it does not index");
+    failedCount++;
+  }
+
+  // a span must hold exactly one object of the store
+  std::vector<ObjectSpan> spans = index.getFileSpans("a.hpp");
+  if (spans.empty()) return failedCount + 1;
+  const std::vector<std::vector<ObjectSpan>> badSpans = {
+      {{spans[0].offset, spans[0].length - 4}},
+      {{spans[0].offset + 4, spans[0].length}},
+      {{0, spans[0].length}},
+      {{fs::file_size(storePath), 4}},
+      {{~uint64_t(0), spans[0].length}},
+  };
+  for (const auto &badSpan : badSpans) {
+    if (!ObjectStore::loadSpans(storePath, badSpan)) continue;
+    spdlog::error("ObjectStore::loadSpans accepted the span {}+{}", badSpan[0].offset, badSpan[0].length);
+    failedCount++;
+  }
+  return failedCount;
+}
+
+/**
+ * @brief Checks that an index cut short, damaged or left by another save is rejected
+ *
+ * @arg indexPath saved index, overwritten
+ * @arg saveId identifier the index was saved with
+ *
+ * @return size_t number of failed cases
+ */
+static auto checkRejectedIndexes(const fs::path &indexPath, uint64_t saveId) -> size_t {
+  size_t failedCount = 0;
+  if (SymbolIndex::load(indexPath, saveId + 1)) {
+    spdlog::error("SymbolIndex::load accepted an index of another save");
+    failedCount++;
+  }
+
+  std::ifstream indexFile(indexPath, std::ios::binary);
+  const std::string data((std::istreambuf_iterator<char>(indexFile)), std::istreambuf_iterator<char>());
+  indexFile.close();
+  // every field is needed, cutting anywhere leaves one unread
+  for (size_t length = 0; length < data.size(); ++length) {
+    writeBytes(indexPath, std::string_view(data).substr(0, length));
+    if (!SymbolIndex::load(indexPath, saveId)) continue;
+    spdlog::error("SymbolIndex::load accepted an index cut to {} of {} bytes", length, data.size());
+    failedCount++;
+  }
+
+  // magic, version, then the file count and the length of the first file blown past the end of the data
+  const size_t fileCountPos = 16;
+  const std::vector<std::pair<size_t, std::string_view>> corruptions = {
+      {0, "X"},
+      {4, "\x07"},
+      {fileCountPos, "\xff\xff\xff\x7f"},
+      {fileCountPos + 4, "\xff\xff\xff\x7f"},
+  };
+  for (const auto &[pos, bytes] : corruptions) {
+    std::string corrupted = data;
+    corrupted.replace(pos, bytes.size(), bytes);
+    writeBytes(indexPath, corrupted);
+    if (!SymbolIndex::load(indexPath, saveId)) continue;
+    spdlog::error("SymbolIndex::load accepted an index corrupted at byte {}", pos);
+    failedCount++;
+  }
+  return failedCount;
+}
+
+auto testSymbolIndex() -> int {
+  const fs::path root = fs::temp_directory_path() / "toxidoc_tests_symbol_index";
+  fs::remove_all(root);
+  fs::create_directories(root);
+  const fs::path storePath = root / "objects.bin";
+  const fs::path indexPath = root / "objects.idx";
+  constexpr uint64_t saveId = 0x5a7e1d;
+
+  const std::vector<Object> objects = {
+      makeObject("a.hpp", "setValue", 1),
+      makeObject("a.hpp", "removed", 5, ObjectState::Removed),
+      makeObject("a.hpp", "abdxbdc", 10),
+      makeObject("dir/b.hpp", "getValue", 1),
+      makeObject("dir/b.hpp", "setValue", 7),
+      makeObject("dir/b.hpp", "abdcz", 12),
+      makeObject("a.hpp", "value", 20),
+  };
+  std::vector<ObjectSpan> spans;
+  size_t failedCount = 0;
+  if (auto saved = ObjectStore::save(storePath, objects, &spans); !saved) {
+    spdlog::error("ObjectStore::save: {}", saved.error());
+    failedCount++;
+  }
+  if (auto saved = SymbolIndex::build(objects, spans).save(indexPath, saveId); !saved) {
+    spdlog::error("SymbolIndex::save: {}", saved.error());
+    failedCount++;
+  }
+
+  auto index = SymbolIndex::load(indexPath, saveId);
+  if (!index) {
+    spdlog::error("SymbolIndex::load: {}", index.error());
+    failedCount++;
+  } else {
+    failedCount += checkQueries(*index) + checkFileSpans(*index, storePath, objects);
+    auto found = index->find("setValue", SymbolMatch::Prefix);
+    std::vector<std::string_view> files = found && found->size() == 1 ? index->getNameFiles(found->front())
+                                                                        : std::vector<std::string_view>{};
+    if (files != std::vector<std::string_view>{"a.hpp", "dir/b.hpp"}) {
+      spdlog::error("SymbolIndex lost the files declaring setValue");
+      failedCount++;
+    }
+    failedCount += checkRejectedIndexes(indexPath, saveId);
+  }
+  fs::remove_all(root);
+  if (failedCount > 0) return 1;
+  spdlog::info("SymbolIndex and ObjectStore spans matched every case");
+  return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef TESTS_HPP_
+#define TESTS_HPP_
+
+/**
+ * @brief Checks mergeObjects against the nested merge it replaced on random objects
+ *
+ * @return int exit code
+ */
+auto testMergeObjects() -> int;
+
+/**
+ * @brief Checks the gitignore-style matching of PathFilter
+ *
+ * @return int exit code
+ */
+auto testPathFilter() -> int;
+
+/**
+ * @brief Checks how compile_commands.json entries are split, reduced to flags and matched to headers
+ *
+ * @return int exit code
+ */
+auto testCompilationDatabase() -> int;
+
+/**
+ * @brief Checks the symbol index round trip, its queries and the objects loaded through its spans
+ *
+ * @return int exit code
+ */
+auto testSymbolIndex() -> int;
+
+#endif /* !TESTS_HPP_ */
@@ -5,6 +5,13 @@ add_rules("mode.debug", "mode.release")
 
 add_requires("nlohmann_json", "spdlog", "barkeep", "cxxopts")
 
+option("alloc_tracking")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Replace the global allocator to count allocations per subsystem (--verbose, --profile)")
+    add_defines("TOXIDOC_ALLOC_TRACKING")
+option_end()
+
 target("toxidoc")
     set_kind("binary")
     set_languages("cxx23")
@@ -12,6 +19,36 @@ target("toxidoc")
     add_includedirs("src")
     add_syslinks("clang")
     add_packages("nlohmann_json", "spdlog", "barkeep", "cxxopts")
+    add_options("alloc_tracking")
+
+    add_configfiles("src/Toxiconfig.h.in", {prefixdir = "config"})
+    add_includedirs("$(builddir)/config")
+
+target("toxidoc_bench")
+    set_kind("binary")
+    set_default(false)
+    set_languages("cxx23")
+    add_files("src/**.cpp|Toxidoc.cpp", "bench/**.cpp")
+    add_includedirs("src")
+    add_syslinks("clang")
+    add_packages("nlohmann_json", "spdlog", "barkeep", "cxxopts")
+    add_options("alloc_tracking")
+
+    add_configfiles("src/Toxiconfig.h.in", {prefixdir = "config"})
+    add_includedirs("$(builddir)/config")
+
+target("toxidoc_tests")
+    set_kind("binary")
+    set_default(false)
+    set_languages("cxx23")
+    add_files("src/**.cpp|Toxidoc.cpp", "tests/**.cpp")
+    add_includedirs("src")
+    add_syslinks("clang")
+    add_packages("nlohmann_json", "spdlog", "barkeep", "cxxopts")
+    add_tests("compilation_database", {runargs = "compilation_database"})
+    add_tests("merge_objects", {runargs = "merge_objects"})
+    add_tests("path_filter", {runargs = "path_filter"})
+    add_tests("symbol_index", {runargs = "symbol_index"})
 
     add_configfiles("src/Toxiconfig.h.in", {prefixdir = "config"})
-    add_includedirs("$(builddir)/config")
\ No newline at end of file
+    add_includedirs("$(builddir)/config")